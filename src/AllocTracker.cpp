@@ -0,0 +1,216 @@
+#include "AllocTracker.h"
+
+#ifdef GOFISH_ALLOC_TRACK
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <new>
+
+namespace {
+
+// Distinct call sites remembered; allocations from any further sites are
+// still counted in the totals and reported as untracked
+const int SITE_SLOTS = 1024;
+const int SITE_PROBES = 32;
+
+struct Site {
+    std::atomic<uintptr_t> address;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> bytes;
+};
+
+// Zero-initialized statics: usable before any constructor has run, which
+// matters because operator new is called during static initialization
+Site g_sites[SITE_SLOTS];
+std::atomic<uint64_t> g_allocations;
+std::atomic<uint64_t> g_frees;
+std::atomic<uint64_t> g_bytes;
+std::atomic<uint64_t> g_untracked;
+
+void noteAllocation(void* caller, size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    uintptr_t address = (uintptr_t)caller;
+    size_t slot = (size_t)((address >> 2) * 0x9E3779B97F4A7C15ull) % SITE_SLOTS;
+    for (int probe = 0; probe < SITE_PROBES; ++probe) {
+        Site& site = g_sites[(slot + probe) % SITE_SLOTS];
+        uintptr_t current = site.address.load(std::memory_order_relaxed);
+        if (current == 0 &&
+            site.address.compare_exchange_strong(current, address, std::memory_order_relaxed)) {
+            current = address;
+        }
+        if (current == address) {
+            site.allocations.fetch_add(1, std::memory_order_relaxed);
+            site.bytes.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+    }
+    g_untracked.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* allocate(size_t size, void* caller) {
+    void* p = std::malloc(size ? size : 1);
+    if (p) {
+        noteAllocation(caller, size);
+    }
+    return p;
+}
+
+void release(void* p) {
+    if (p) {
+        g_frees.fetch_add(1, std::memory_order_relaxed);
+        std::free(p);
+    }
+}
+
+struct SiteCount {
+    uintptr_t address;
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+void printSite(std::ostream& out, const SiteCount& site) {
+    // Return addresses point after the call; step back into it so
+    // addr2line names the calling line
+    uintptr_t address = site.address - 1;
+    char line[512];
+    Dl_info info;
+    if (dladdr((void*)address, &info) && info.dli_fname) {
+        const char* module = std::strrchr(info.dli_fname, '/');
+        module = module ? module + 1 : info.dli_fname;
+        int status = -1;
+        char* symbol = info.dli_sname ?
+            abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status) : nullptr;
+        snprintf(line, sizeof(line), "%12llu %12llu  %s+0x%lx  %.200s\n",
+                 (unsigned long long)site.allocations, (unsigned long long)site.bytes, module,
+                 (unsigned long)(address - (uintptr_t)info.dli_fbase),
+                 symbol ? symbol : info.dli_sname ? info.dli_sname : "?");
+        std::free(symbol);
+    } else {
+        snprintf(line, sizeof(line), "%12llu %12llu  0x%lx\n", (unsigned long long)site.allocations,
+                 (unsigned long long)site.bytes, (unsigned long)address);
+    }
+    out << line;
+}
+
+} // namespace
+
+namespace AllocTracker {
+
+Totals totals() {
+    return Totals{g_allocations.load(std::memory_order_relaxed),
+                  g_frees.load(std::memory_order_relaxed),
+                  g_bytes.load(std::memory_order_relaxed)};
+}
+
+void report(std::ostream& out, int maxSites) {
+    // Copied to the stack so reporting itself stays off the heap
+    SiteCount sites[SITE_SLOTS];
+    int count = 0;
+    for (int i = 0; i < SITE_SLOTS; ++i) {
+        uint64_t allocations = g_sites[i].allocations.load(std::memory_order_relaxed);
+        if (allocations > 0) {
+            sites[count++] = SiteCount{g_sites[i].address.load(std::memory_order_relaxed),
+                                       allocations,
+                                       g_sites[i].bytes.load(std::memory_order_relaxed)};
+        }
+    }
+    std::sort(sites, sites + count, [](const SiteCount& a, const SiteCount& b) {
+        return a.allocations > b.allocations;
+    });
+
+    Totals all = totals();
+    char line[160];
+    snprintf(line, sizeof(line), "Allocations: %llu (%llu bytes), frees: %llu, %d call site(s)\n",
+             (unsigned long long)all.allocations, (unsigned long long)all.bytes,
+             (unsigned long long)all.frees, count);
+    out << line;
+    if (count == 0) {
+        return;
+    }
+    snprintf(line, sizeof(line), "%12s %12s  %s\n", "allocs", "bytes", "call site");
+    out << line;
+    for (int i = 0; i < count && i < maxSites; ++i) {
+        printSite(out, sites[i]);
+    }
+    uint64_t untracked = g_untracked.load(std::memory_order_relaxed);
+    if (untracked > 0) {
+        snprintf(line, sizeof(line), "%12llu %12s  (site table full)\n",
+                 (unsigned long long)untracked, "-");
+        out << line;
+    }
+}
+
+// Meant for quiet points: an allocation racing with it may land on either side
+void reset() {
+    for (int i = 0; i < SITE_SLOTS; ++i) {
+        g_sites[i].allocations.store(0, std::memory_order_relaxed);
+        g_sites[i].bytes.store(0, std::memory_order_relaxed);
+    }
+    g_allocations.store(0, std::memory_order_relaxed);
+    g_frees.store(0, std::memory_order_relaxed);
+    g_bytes.store(0, std::memory_order_relaxed);
+    g_untracked.store(0, std::memory_order_relaxed);
+}
+
+} // namespace AllocTracker
+
+// Replacement global allocation functions. Each form calls allocate()
+// itself so __builtin_return_address names the real caller.
+
+void* operator new(size_t size) {
+    void* p = allocate(size, __builtin_return_address(0));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = allocate(size, __builtin_return_address(0));
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, __builtin_return_address(0));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size, __builtin_return_address(0));
+}
+
+void operator delete(void* p) noexcept {
+    release(p);
+}
+
+void operator delete[](void* p) noexcept {
+    release(p);
+}
+
+// Sized forms, used from C++14 on; free() does not need the size
+void operator delete(void* p, size_t) noexcept {
+    release(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    release(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    release(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    release(p);
+}
+
+#endif // GOFISH_ALLOC_TRACK
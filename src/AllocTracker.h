@@ -0,0 +1,46 @@
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+
+#include <cstdint>
+#include <ostream>
+
+// Heap accounting, compiled in only with -DGOFISH_ALLOC_TRACK (make
+// alloc-check). The global operator new/delete are then replaced by
+// counting versions that attribute every allocation to the address it was
+// called from; report() lists the busiest call sites as module+offset
+// (resolve with addr2line -f -C -e <module> <offset>) plus the symbol when
+// the dynamic linker knows it.
+//
+// Counting is a few relaxed atomic adds per allocation and never allocates
+// itself, so it is safe from any thread, including the audio mixer.
+
+namespace AllocTracker {
+
+struct Totals {
+    uint64_t allocations;
+    uint64_t frees;
+    uint64_t bytes; // Requested, summed over allocations
+};
+
+#ifdef GOFISH_ALLOC_TRACK
+
+inline bool enabled() { return true; }
+
+Totals totals();
+
+// Busiest call sites since the last reset(), most allocations first
+void report(std::ostream& out, int maxSites = 16);
+void reset();
+
+#else
+
+inline bool enabled() { return false; }
+inline Totals totals() { return Totals{0, 0, 0}; }
+inline void report(std::ostream&, int = 16) {}
+inline void reset() {}
+
+#endif // GOFISH_ALLOC_TRACK
+
+} // namespace AllocTracker
+
+#endif // ALLOCTRACKER_H
@@ -0,0 +1,122 @@
+#include "AudioEngine.h"
+#include "Profiler.h"
+#include "Tracer.h"
+#include <iostream>
+
+const float DEFAULT_COOLDOWN = 0.04f; // Seconds
+
+AudioEngine::AudioEngine()
+    : m_running(false), m_maxVoices(MIXER_DEFAULT_VOICES), m_cooldown(DEFAULT_COOLDOWN),
+      m_activeVoices(0), m_volume(1.0f), m_dropped(0) {
+}
+
+AudioEngine::~AudioEngine() {
+    stop();
+}
+
+bool AudioEngine::start(std::unique_ptr<AudioSink> sink, const AudioFormat& format) {
+    stop();
+    if (!sink || !sink->open(format)) {
+        return false;
+    }
+
+    m_sink = std::move(sink);
+    m_format = format;
+    m_output.assign(format.periodFrames * format.channels, 0);
+    m_mixer.setChannels(format.channels);
+    m_mixer.setMasterVolume(m_volume);
+    m_mixer.stopAll();
+
+    m_running = true;
+    m_thread = std::thread(&AudioEngine::mixerLoop, this);
+    return true;
+}
+
+void AudioEngine::stop() {
+    // The thread may already have stopped itself after a write error
+    m_running = false;
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_sink) {
+        m_sink->close();
+        m_sink.reset();
+    }
+    // With the mixer thread gone this thread may drain the ring
+    Command command;
+    while (m_commands.pop(command)) {
+    }
+    m_mixer.stopAll();
+    m_activeVoices = 0;
+}
+
+void AudioEngine::post(const Command& command) {
+    if (!m_commands.push(command)) {
+        ++m_dropped;
+    }
+}
+
+void AudioEngine::play(const int16_t* samples, size_t count, float gain, int sound,
+                       uint64_t emittedAt) {
+    if (!m_running || !samples || count == 0) {
+        return;
+    }
+    post(Command{Command::PLAY, sound, samples, count, gain, emittedAt});
+}
+
+void AudioEngine::stopSound(int sound) {
+    if (m_running) {
+        post(Command{Command::STOP, sound, nullptr, 0, 0.0f, 0});
+    }
+}
+
+void AudioEngine::setVolume(float volume) {
+    m_volume = volume;
+    if (m_running) {
+        post(Command{Command::SET_VOLUME, -1, nullptr, 0, volume, 0});
+    }
+}
+
+void AudioEngine::mixerLoop() {
+    Tracer::setThreadName("audio mixer");
+    while (m_running) {
+        mix(m_format.periodFrames);
+        if (!m_sink->write(m_output.data(), m_format.periodFrames)) {
+            std::cerr << "Warning: audio output failed; stopping mixer" << std::endl;
+            m_running = false;
+        }
+    }
+}
+
+void AudioEngine::mix(int frames) {
+    PROFILE_SCOPE(AUDIO_MIX);
+    TRACE_SPAN("mix", "audio");
+    m_mixer.setMaxVoices(m_maxVoices);
+    m_mixer.setCooldownFrames((int)(m_cooldown * m_format.sampleRate));
+
+    // Apply everything posted since the last period, in order
+    Command command;
+    uint64_t now = 0;
+    while (m_commands.pop(command)) {
+        switch (command.type) {
+        case Command::PLAY:
+            m_mixer.start(command.samples, command.count, command.gain, command.sound);
+            TRACE_INSTANT("voice_start", "audio", command.sound);
+            if (command.emittedAt) {
+                now = now ? now : monotonicNs();
+                m_startLatency.record(now - command.emittedAt);
+            }
+            break;
+        case Command::STOP:
+            m_mixer.stop(command.sound);
+            break;
+        case Command::SET_VOLUME:
+            m_mixer.setMasterVolume(command.gain);
+            break;
+        }
+    }
+
+    PROFILE_COUNT(AUDIO_VOICES_MIXED, m_mixer.activeVoices());
+    m_mixer.mix(m_output.data(), frames);
+    m_activeVoices = m_mixer.activeVoices();
+}
@@ -0,0 +1,90 @@
+#ifndef AUDIOENGINE_H
+#define AUDIOENGINE_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "AudioSink.h"
+#include "LatencyHistogram.h"
+#include "Mixer.h"
+#include "SpscRing.h"
+
+// Commands waiting in the ring beyond this are dropped
+const size_t AUDIO_COMMAND_CAPACITY = 256;
+
+// In-process software mixer. One long-lived thread mixes all playing
+// voices one period at a time and hands the result to an AudioSink.
+//
+// play(), stopSound() and setVolume() post commands to a wait-free ring
+// the mixer drains each period. They must all be called from one thread
+// (the game thread); none of them blocks, allocates or takes a lock.
+class AudioEngine {
+public:
+    AudioEngine();
+    ~AudioEngine();
+
+    bool start(std::unique_ptr<AudioSink> sink, const AudioFormat& format = AudioFormat());
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    const AudioFormat& format() const { return m_format; }
+    const char* sinkName() const { return m_sink ? m_sink->name() : "none"; }
+    const char* kernelName() const { return mixKernelName(m_mixer.getKernel()); }
+
+    // Start a voice playing `count` interleaved samples in the output format.
+    // The samples are not copied and must outlive the voice. `sound` groups
+    // repeats of the same sound for cooldown merging and stopSound().
+    // A nonzero `emittedAt` (monotonicNs) is measured against the moment
+    // the mixer starts the voice.
+    void play(const int16_t* samples, size_t count, float gain, int sound = -1,
+              uint64_t emittedAt = 0);
+
+    // Silence every voice started with `sound`
+    void stopSound(int sound);
+
+    void setVolume(float volume);
+
+    // Mixer settings; may be changed from any thread and are picked up at
+    // the start of the next period
+    void setMaxVoices(int voices) { m_maxVoices = voices; }
+    void setCooldown(float seconds) { m_cooldown = seconds; }
+
+    int activeVoices() const { return m_activeVoices.load(); }
+    size_t queuedCommands() const { return m_commands.size(); }
+    uint64_t droppedCommands() const { return m_dropped; }
+    const LatencyHistogram& startLatency() const { return m_startLatency; }
+
+private:
+    struct Command {
+        enum Type { PLAY, STOP, SET_VOLUME };
+        Type type;
+        int sound;
+        const int16_t* samples;
+        size_t count;
+        float gain; // Voice gain, or the master volume for SET_VOLUME
+        uint64_t emittedAt;
+    };
+
+    std::unique_ptr<AudioSink> m_sink;
+    AudioFormat m_format;
+    std::thread m_thread;
+    std::atomic<bool> m_running;
+
+    std::atomic<int> m_maxVoices;
+    std::atomic<float> m_cooldown;
+    std::atomic<int> m_activeVoices;
+    float m_volume;      // Last volume posted, reapplied on start()
+    uint64_t m_dropped;  // Producer thread only
+
+    SpscRing<Command, AUDIO_COMMAND_CAPACITY> m_commands;
+    LatencyHistogram m_startLatency; // Recorded by the mixer thread
+    Mixer m_mixer; // Mixer thread only while running
+    std::vector<int16_t> m_output;
+
+    void post(const Command& command);
+    void mixerLoop();
+    void mix(int frames);
+};
+
+#endif // AUDIOENGINE_H
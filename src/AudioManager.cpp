@@ -1,7 +1,8 @@
 #include "AudioManager.h"
+#include "Profiler.h"
 #include <iostream>
-#include <cstdlib>
-#include <thread>
+
+const char* SOUND_DIRECTORY = "assets/sounds";
 
 AudioManager::AudioManager() 
     : m_enabled(true), m_volume(0.7f) {
@@ -11,57 +12,65 @@ AudioManager::~AudioManager() {
     cleanup();
 }
 
-bool AudioManager::initialize() {
-    // Check if aplay (ALSA player) is available
-    int result = system("which aplay > /dev/null 2>&1");
-    if (result != 0) {
-        std::cerr << "Warning: aplay not found. Audio will be disabled." << std::endl;
+bool AudioManager::initialize(const std::string& sinkSpec) {
+    m_engine.setVolume(m_volume);
+    
+    std::unique_ptr<AudioSink> sink = AudioSink::create(sinkSpec);
+    if (!sink) {
+        std::cerr << "Warning: no audio output for '" << sinkSpec
+                  << "' (built without ALSA?). Audio will be disabled." << std::endl;
+        m_enabled = false;
+        return false;
+    }
+    
+    if (!m_engine.start(std::move(sink))) {
+        std::cerr << "Warning: cannot open audio output. Audio will be disabled." << std::endl;
         m_enabled = false;
         return false;
     }
     
+    // Decode everything up front so playback never touches the filesystem
+    m_bank.setFormat(m_engine.format());
+    m_bank.loadDirectory(SOUND_DIRECTORY);
+    
     m_enabled = true;
     return true;
 }
 
 void AudioManager::cleanup() {
-    // Nothing to cleanup for simple implementation
+    m_engine.stop();
 }
 
 bool AudioManager::loadSound(const std::string& name, const std::string& filepath) {
-    // For simple implementation, we just verify the file exists
-    // In a more complex implementation, we would load the sound into memory
-    return true;
+    return m_bank.load(name, filepath) != INVALID_SOUND;
 }
 
-void AudioManager::playSound(const std::string& name) {
-    if (!m_enabled) {
+void AudioManager::playSound(SoundId id, uint64_t emittedAt) {
+    if (!m_enabled || !m_bank.isValid(id)) {
         return;
     }
-    
-    // For now, we'll play sounds directly from assets folder
-    std::string filepath = "assets/sounds/" + name + ".wav";
-    playWavFile(filepath);
+    PROFILE_SCOPE(AUDIO_DISPATCH);
+    PROFILE_COUNT(AUDIO_SOUNDS, 1);
+    m_engine.play(m_bank.samples(id), m_bank.sampleCount(id), 1.0f, id, emittedAt);
+}
+
+void AudioManager::playSound(const std::string& name) {
+    playSound(m_bank.find(name));
+}
+
+void AudioManager::stopSound(SoundId id) {
+    if (m_bank.isValid(id)) {
+        m_engine.stopSound(id);
+    }
 }
 
 void AudioManager::stopSound(const std::string& name) {
-    // Simple implementation doesn't support stopping
+    stopSound(m_bank.find(name));
 }
 
 void AudioManager::setVolume(float volume) {
     if (volume < 0.0f) volume = 0.0f;
     if (volume > 1.0f) volume = 1.0f;
     m_volume = volume;
+    m_engine.setVolume(volume);
 }
-
-void AudioManager::playWavFile(const std::string& filepath) {
-    if (!m_enabled) {
-        return;
-    }
-    
-    // Play sound in background thread to avoid blocking
-    std::thread([filepath]() {
-        std::string command = "aplay -q " + filepath + " 2>/dev/null &";
-        system(command.c_str());
-    }).detach();
-}
\ No newline at end of file
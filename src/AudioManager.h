@@ -2,22 +2,44 @@
 #define AUDIOMANAGER_H
 
 #include <string>
+#include "AudioEngine.h"
+#include "SoundBank.h"
 
 class AudioManager {
 public:
     AudioManager();
     ~AudioManager();
     
-    bool initialize();
+    // sinkSpec selects the output: "" or "alsa[:device]" for the sound card,
+    // "null" to discard audio, "wav:path" to record it to a file.
+    // Preloads every sound in assets/sounds.
+    bool initialize(const std::string& sinkSpec = "");
     void cleanup();
     
     bool loadSound(const std::string& name, const std::string& filepath);
+    
+    // Resolve a name once, then play by ID; INVALID_SOUND if not loaded.
+    // Playback calls only post to the mixer's command ring and must come
+    // from a single thread.
+    SoundId findSound(const std::string& name) const { return m_bank.find(name); }
+    void playSound(SoundId id, uint64_t emittedAt = 0);
     void playSound(const std::string& name);
+    void stopSound(SoundId id);
     void stopSound(const std::string& name);
     
     void setVolume(float volume); // 0.0 to 1.0
     float getVolume() const { return m_volume; }
     
+    // Most sounds audible at once; further starts steal the oldest voice
+    void setMaxVoices(int voices) { m_engine.setMaxVoices(voices); }
+    
+    // Time from a game event's emission to its sound starting in the mixer
+    const LatencyHistogram& getSoundLatency() const { return m_engine.startLatency(); }
+    
+    // Mixer state for the performance HUD
+    int getActiveVoices() const { return m_engine.activeVoices(); }
+    size_t getQueuedCommands() const { return m_engine.queuedCommands(); }
+    
     bool isEnabled() const { return m_enabled; }
     void setEnabled(bool enabled) { m_enabled = enabled; }
     
@@ -25,8 +47,11 @@ private:
     bool m_enabled;
     float m_volume;
     
-    // Simple implementation - will use system commands for audio playback
-    void playWavFile(const std::string& filepath);
+    // Declared before the engine so voices never outlive their samples
+    SoundBank m_bank;
+    
+    // Mixer thread writing to the selected sink
+    AudioEngine m_engine;
 };
 
 #endif // AUDIOMANAGER_H
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "AudioSink.h"
+#include <cstring>
+#include <thread>
+
+#ifdef HAVE_ALSA
+#include <alsa/asoundlib.h>
+#endif
+
+std::unique_ptr<AudioSink> AudioSink::create(const std::string& spec) {
+    if (spec == "null") {
+        return std::unique_ptr<AudioSink>(new NullAudioSink());
+    }
+    if (spec.compare(0, 4, "wav:") == 0 && spec.size() > 4) {
+        return std::unique_ptr<AudioSink>(new WavFileAudioSink(spec.substr(4)));
+    }
+#ifdef HAVE_ALSA
+    if (spec.empty() || spec == "alsa") {
+        return std::unique_ptr<AudioSink>(new AlsaAudioSink("default"));
+    }
+    if (spec.compare(0, 5, "alsa:") == 0) {
+        return std::unique_ptr<AudioSink>(new AlsaAudioSink(spec.substr(5)));
+    }
+#endif
+    return std::unique_ptr<AudioSink>();
+}
+
+// NullAudioSink
+
+bool NullAudioSink::open(const AudioFormat& format) {
+    m_format = format;
+    m_deadline = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool NullAudioSink::write(const int16_t* samples, int frames) {
+    (void)samples;
+    pace(frames);
+    return true;
+}
+
+void NullAudioSink::pace(int frames) {
+    m_deadline += std::chrono::microseconds((int64_t)frames * 1000000 / m_format.sampleRate);
+    auto now = std::chrono::steady_clock::now();
+    if (m_deadline < now) {
+        m_deadline = now; // Fell behind (e.g. suspended); don't try to catch up
+    } else {
+        std::this_thread::sleep_until(m_deadline);
+    }
+}
+
+// WavFileAudioSink
+
+WavFileAudioSink::WavFileAudioSink(const std::string& path)
+    : m_path(path), m_file(nullptr), m_dataBytes(0) {
+}
+
+WavFileAudioSink::~WavFileAudioSink() {
+    close();
+}
+
+bool WavFileAudioSink::open(const AudioFormat& format) {
+    NullAudioSink::open(format);
+    m_file = fopen(m_path.c_str(), "wb");
+    if (!m_file) {
+        return false;
+    }
+    m_dataBytes = 0;
+    writeHeader();
+    return true;
+}
+
+bool WavFileAudioSink::write(const int16_t* samples, int frames) {
+    size_t count = (size_t)frames * m_format.channels;
+    if (fwrite(samples, sizeof(int16_t), count, m_file) != count) {
+        return false;
+    }
+    m_dataBytes += count * sizeof(int16_t);
+    pace(frames);
+    return true;
+}
+
+void WavFileAudioSink::close() {
+    if (!m_file) {
+        return;
+    }
+    // Patch the chunk sizes now that the length is known
+    fseek(m_file, 0, SEEK_SET);
+    writeHeader();
+    fclose(m_file);
+    m_file = nullptr;
+}
+
+void WavFileAudioSink::writeHeader() {
+    uint32_t byteRate = m_format.sampleRate * m_format.channels * 2;
+    uint16_t blockAlign = m_format.channels * 2;
+    unsigned char header[44];
+    auto put32 = [&header](int offset, uint32_t v) {
+        header[offset] = v;
+        header[offset + 1] = v >> 8;
+        header[offset + 2] = v >> 16;
+        header[offset + 3] = v >> 24;
+    };
+    auto put16 = [&header](int offset, uint16_t v) {
+        header[offset] = v;
+        header[offset + 1] = v >> 8;
+    };
+    memcpy(header, "RIFF", 4);
+    put32(4, 36 + m_dataBytes);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    put32(16, 16);
+    put16(20, 1); // PCM
+    put16(22, m_format.channels);
+    put32(24, m_format.sampleRate);
+    put32(28, byteRate);
+    put16(32, blockAlign);
+    put16(34, 16);
+    memcpy(header + 36, "data", 4);
+    put32(40, m_dataBytes);
+    fwrite(header, 1, sizeof(header), m_file);
+}
+
+// AlsaAudioSink
+
+#ifdef HAVE_ALSA
+AlsaAudioSink::AlsaAudioSink(const std::string& device)
+    : m_device(device), m_pcm(nullptr), m_channels(2) {
+}
+
+AlsaAudioSink::~AlsaAudioSink() {
+    close();
+}
+
+bool AlsaAudioSink::open(const AudioFormat& format) {
+    if (snd_pcm_open(&m_pcm, m_device.c_str(), SND_PCM_STREAM_PLAYBACK, 0) < 0) {
+        m_pcm = nullptr;
+        return false;
+    }
+    // Keep roughly three periods queued in the device
+    unsigned int latencyUs = 3u * format.periodFrames * 1000000u / format.sampleRate;
+    if (snd_pcm_set_params(m_pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED,
+                           format.channels, format.sampleRate, 1, latencyUs) < 0) {
+        close();
+        return false;
+    }
+    m_channels = format.channels;
+    return true;
+}
+
+bool AlsaAudioSink::write(const int16_t* samples, int frames) {
+    while (frames > 0) {
+        snd_pcm_sframes_t written = snd_pcm_writei(m_pcm, samples, frames);
+        if (written < 0) {
+            // Underrun or suspend: recover and retry the same period
+            if (snd_pcm_recover(m_pcm, (int)written, 1) < 0) {
+                return false;
+            }
+            continue;
+        }
+        samples += written * m_channels;
+        frames -= written;
+    }
+    return true;
+}
+
+void AlsaAudioSink::close() {
+    if (m_pcm) {
+        snd_pcm_drop(m_pcm);
+        snd_pcm_close(m_pcm);
+        m_pcm = nullptr;
+    }
+}
+#endif
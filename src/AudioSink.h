@@ -0,0 +1,88 @@
+#ifndef AUDIOSINK_H
+#define AUDIOSINK_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// Output format of the mixer: interleaved signed 16-bit PCM
+struct AudioFormat {
+    int sampleRate = 44100;
+    int channels = 2;
+    int periodFrames = 512; // Frames mixed and written per iteration
+};
+
+// Destination for mixed audio. write() is called from the mixer thread
+// only and blocks (or paces itself) so that one period of audio takes one
+// period of wall-clock time.
+class AudioSink {
+public:
+    virtual ~AudioSink() {}
+
+    virtual bool open(const AudioFormat& format) = 0;
+    virtual bool write(const int16_t* samples, int frames) = 0;
+    virtual void close() = 0;
+    virtual const char* name() const = 0;
+
+    // Create a sink from a spec: "alsa[:device]", "null" or "wav:path"
+    static std::unique_ptr<AudioSink> create(const std::string& spec);
+};
+
+// Discards audio while pacing writes in real time; for machines without
+// sound hardware
+class NullAudioSink : public AudioSink {
+public:
+    bool open(const AudioFormat& format) override;
+    bool write(const int16_t* samples, int frames) override;
+    void close() override {}
+    const char* name() const override { return "null"; }
+
+protected:
+    AudioFormat m_format;
+    std::chrono::steady_clock::time_point m_deadline;
+    void pace(int frames);
+};
+
+// Records everything the mixer produces to a WAV file (real-time paced)
+class WavFileAudioSink : public NullAudioSink {
+public:
+    explicit WavFileAudioSink(const std::string& path);
+    ~WavFileAudioSink();
+
+    bool open(const AudioFormat& format) override;
+    bool write(const int16_t* samples, int frames) override;
+    void close() override;
+    const char* name() const override { return "wav"; }
+
+private:
+    std::string m_path;
+    FILE* m_file;
+    uint32_t m_dataBytes;
+
+    void writeHeader();
+};
+
+#ifdef HAVE_ALSA
+typedef struct _snd_pcm snd_pcm_t;
+
+// Blocking playback through an ALSA PCM device
+class AlsaAudioSink : public AudioSink {
+public:
+    explicit AlsaAudioSink(const std::string& device);
+    ~AlsaAudioSink();
+
+    bool open(const AudioFormat& format) override;
+    bool write(const int16_t* samples, int frames) override;
+    void close() override;
+    const char* name() const override { return "alsa"; }
+
+private:
+    std::string m_device;
+    snd_pcm_t* m_pcm;
+    int m_channels;
+};
+#endif
+
+#endif // AUDIOSINK_H
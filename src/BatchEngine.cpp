@@ -0,0 +1,428 @@
+#include "BatchEngine.h"
+#include "DealCache.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const int HAND_SIZE = 7;
+const int32_t RANK_BITS = 0x1555555; // Low bit of each rank's 2-bit field
+
+// The leading outputs of a freshly seeded GameRng, computed on demand.
+// Seeding fills 624 words and the first draw twists all of them, but output
+// i < 227 only depends on seeded words i, i + 1 and i + 397, and a shuffle
+// of 52 cards needs a few dozen outputs. Later outputs fall back to a
+// full generator, so the sequence is always exactly GameRng's.
+class DeckRng {
+public:
+    typedef uint32_t result_type;
+    static constexpr result_type min() { return GameRng::min(); }
+    static constexpr result_type max() { return GameRng::max(); }
+
+    explicit DeckRng(uint32_t seed) : m_seed(seed), m_seeded(1), m_next(0) {
+        m_words[0] = seed;
+    }
+
+    result_type operator()() {
+        uint32_t i = m_next++;
+        if (i >= SHORTCUT) {
+            GameRng full(m_seed);
+            full.discard(i);
+            return full();
+        }
+        seedThrough(i + 397);
+        uint32_t y = (m_words[i] & 0x80000000u) | (m_words[i + 1] & 0x7fffffffu);
+        y = m_words[i + 397] ^ (y >> 1) ^ ((y & 1) ? 0x9908b0dfu : 0);
+        y ^= y >> 11;
+        y ^= (y << 7) & 0x9d2c5680u;
+        y ^= (y << 15) & 0xefc60000u;
+        return y ^ (y >> 18);
+    }
+
+private:
+    static const uint32_t SHORTCUT = 624 - 397;
+
+    uint32_t m_words[624];
+    uint32_t m_seed;
+    uint32_t m_seeded;
+    uint32_t m_next;
+
+    void seedThrough(uint32_t last) {
+        for (; m_seeded <= last; ++m_seeded) {
+            uint32_t prev = m_words[m_seeded - 1];
+            m_words[m_seeded] = 1812433253u * (prev ^ (prev >> 30)) + m_seeded;
+        }
+    }
+};
+
+// Bit 2(r-1) set for every rank held
+inline int32_t presence(int32_t hand) {
+    return (hand | (hand >> 1)) & RANK_BITS;
+}
+
+// One turn of one lane, mirroring GameEngine::stepGame. Returns true when
+// the game ended instead of taking a turn.
+bool stepLane(BatchEngine::Lanes& s, int lane) {
+    int32_t* hand0 = &s.hand[0][lane];
+    int32_t* hand1 = &s.hand[1][lane];
+    bool pileEmpty = s.cursor[lane] == BatchEngine::DECK;
+    bool noMoves = (presence(*hand0) & ~s.denied[0][lane]) == 0 &&
+                   (presence(*hand1) & ~s.denied[1][lane]) == 0;
+    if ((pileEmpty && (*hand0 == 0 || *hand1 == 0)) || (*hand0 == 0 && *hand1 == 0) ||
+        (pileEmpty && noMoves)) {
+        s.over[lane] = -1;
+        return true;
+    }
+    ++s.steps[lane];
+
+    int p = s.turn[lane];
+    int32_t& pHand = s.hand[p][lane];
+    int32_t& oHand = s.hand[1 - p][lane];
+    int32_t& denied = s.denied[p][lane];
+    int32_t available = presence(pHand) & ~denied;
+    if (available == 0) {
+        s.turn[lane] = 1 - p;
+        return false;
+    }
+
+    int shift = __builtin_ctz(available); // Lowest rank not yet denied
+    int32_t field = 3 << shift;
+    int theirs = (oHand >> shift) & 3;
+    if (theirs > 0) {
+        int count = ((pHand >> shift) & 3) + theirs;
+        oHand &= ~field;
+        pHand &= ~field;
+        if (count == 4) {
+            ++s.books[p][lane];
+        } else {
+            pHand |= count << shift;
+        }
+        denied = 0;
+        return false;
+    }
+
+    if (pileEmpty) {
+        denied |= 1 << shift;
+        s.turn[lane] = 1 - p;
+        return false;
+    }
+    int drawn = s.pile[lane * BatchEngine::DECK + s.cursor[lane]++];
+    int drawnShift = 2 * (drawn - 1);
+    int count = ((pHand >> drawnShift) & 3) + 1;
+    pHand &= ~(3 << drawnShift);
+    if (count == 4) {
+        ++s.books[p][lane];
+    } else {
+        pHand |= count << drawnShift;
+    }
+    denied = 0;
+    if (drawnShift != shift) {
+        s.turn[lane] = 1 - p;
+    }
+    return false;
+}
+
+// Lockstep turns over every lane until at least one game ends
+void stepPortable(BatchEngine::Lanes& s) {
+    for (;;) {
+        bool ended = false;
+        bool playing = false;
+        for (int lane = 0; lane < BatchEngine::LANES; ++lane) {
+            if (s.live[lane] && !s.over[lane]) {
+                playing = true;
+                ended |= stepLane(s, lane);
+            }
+        }
+        if (ended || !playing) {
+            return;
+        }
+    }
+}
+
+#ifdef BATCH_X86
+
+// One group of eight games held in registers
+struct GroupState {
+    __m256i hand0, hand1, denied0, denied1, books0, books1;
+    __m256i turn, cursor, steps, over, live;
+};
+
+__attribute__((target("avx2")))
+inline void loadGroup(GroupState& g, const BatchEngine::Lanes& s, int base) {
+    g.hand0 = _mm256_load_si256((const __m256i*)&s.hand[0][base]);
+    g.hand1 = _mm256_load_si256((const __m256i*)&s.hand[1][base]);
+    g.denied0 = _mm256_load_si256((const __m256i*)&s.denied[0][base]);
+    g.denied1 = _mm256_load_si256((const __m256i*)&s.denied[1][base]);
+    g.books0 = _mm256_load_si256((const __m256i*)&s.books[0][base]);
+    g.books1 = _mm256_load_si256((const __m256i*)&s.books[1][base]);
+    g.turn = _mm256_load_si256((const __m256i*)&s.turn[base]);
+    g.cursor = _mm256_load_si256((const __m256i*)&s.cursor[base]);
+    g.steps = _mm256_load_si256((const __m256i*)&s.steps[base]);
+    g.over = _mm256_load_si256((const __m256i*)&s.over[base]);
+    g.live = _mm256_load_si256((const __m256i*)&s.live[base]);
+}
+
+__attribute__((target("avx2")))
+inline void storeGroup(const GroupState& g, BatchEngine::Lanes& s, int base) {
+    _mm256_store_si256((__m256i*)&s.hand[0][base], g.hand0);
+    _mm256_store_si256((__m256i*)&s.hand[1][base], g.hand1);
+    _mm256_store_si256((__m256i*)&s.denied[0][base], g.denied0);
+    _mm256_store_si256((__m256i*)&s.denied[1][base], g.denied1);
+    _mm256_store_si256((__m256i*)&s.books[0][base], g.books0);
+    _mm256_store_si256((__m256i*)&s.books[1][base], g.books1);
+    _mm256_store_si256((__m256i*)&s.turn[base], g.turn);
+    _mm256_store_si256((__m256i*)&s.cursor[base], g.cursor);
+    _mm256_store_si256((__m256i*)&s.steps[base], g.steps);
+    _mm256_store_si256((__m256i*)&s.over[base], g.over);
+}
+
+__attribute__((target("avx2")))
+inline __m256i presenceAvx2(__m256i hand) {
+    return _mm256_and_si256(_mm256_or_si256(hand, _mm256_srli_epi32(hand, 1)),
+                            _mm256_set1_epi32(RANK_BITS));
+}
+
+// stepLane for eight lanes at once. Every branch of the scalar version is
+// evaluated and the results blended by lane mask. Returns the lanes whose
+// game ended this call.
+__attribute__((target("avx2")))
+inline __m256i stepGroup(GroupState& g, const int32_t* pile, __m256i pileBase) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i three = _mm256_set1_epi32(3);
+    const __m256i four = _mm256_set1_epi32(4);
+
+    __m256i playing = _mm256_andnot_si256(g.over, g.live);
+    __m256i pileEmpty = _mm256_cmpeq_epi32(g.cursor, _mm256_set1_epi32(BatchEngine::DECK));
+    __m256i empty0 = _mm256_cmpeq_epi32(g.hand0, zero);
+    __m256i empty1 = _mm256_cmpeq_epi32(g.hand1, zero);
+    __m256i noMoves = _mm256_and_si256(
+        _mm256_cmpeq_epi32(_mm256_andnot_si256(g.denied0, presenceAvx2(g.hand0)), zero),
+        _mm256_cmpeq_epi32(_mm256_andnot_si256(g.denied1, presenceAvx2(g.hand1)), zero));
+    __m256i ending = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(pileEmpty, _mm256_or_si256(empty0, empty1)),
+                        _mm256_and_si256(empty0, empty1)),
+        _mm256_and_si256(pileEmpty, noMoves));
+    __m256i end = _mm256_and_si256(playing, ending);
+    __m256i go = _mm256_andnot_si256(end, playing);
+
+    // Gather the mover's side of every lane
+    __m256i second = _mm256_cmpeq_epi32(g.turn, one);
+    __m256i pHand = _mm256_blendv_epi8(g.hand0, g.hand1, second);
+    __m256i oHand = _mm256_blendv_epi8(g.hand1, g.hand0, second);
+    __m256i pDenied = _mm256_blendv_epi8(g.denied0, g.denied1, second);
+    __m256i pBooks = _mm256_blendv_epi8(g.books0, g.books1, second);
+
+    __m256i available = _mm256_andnot_si256(pDenied, presenceAvx2(pHand));
+    __m256i noRank = _mm256_cmpeq_epi32(available, zero);
+    __m256i skip = _mm256_and_si256(go, noRank);
+    __m256i ask = _mm256_andnot_si256(noRank, go);
+
+    // Lowest available bit, located through the float exponent (exact:
+    // it is at most 2^24). Lanes without one get a huge shift, i.e. zeros.
+    __m256i lowest = _mm256_and_si256(available, _mm256_sub_epi32(zero, available));
+    __m256i shift = _mm256_sub_epi32(
+        _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(lowest)), 23),
+        _mm256_set1_epi32(127));
+    __m256i field = _mm256_sllv_epi32(three, shift);
+    __m256i theirs = _mm256_and_si256(_mm256_srlv_epi32(oHand, shift), three);
+    __m256i mine = _mm256_and_si256(_mm256_srlv_epi32(pHand, shift), three);
+    __m256i has = _mm256_cmpgt_epi32(theirs, zero);
+    __m256i transfer = _mm256_and_si256(ask, has);
+    __m256i fish = _mm256_andnot_si256(has, ask);
+
+    // Opponent hands over the rank
+    __m256i total = _mm256_add_epi32(mine, theirs);
+    __m256i bookT = _mm256_and_si256(transfer, _mm256_cmpeq_epi32(total, four));
+    __m256i handT = _mm256_or_si256(_mm256_andnot_si256(field, pHand),
+                                    _mm256_andnot_si256(bookT, _mm256_sllv_epi32(total, shift)));
+
+    // Go fish: draw where the pile has cards
+    __m256i draw = _mm256_andnot_si256(pileEmpty, fish);
+    __m256i noDraw = _mm256_and_si256(fish, pileEmpty);
+    __m256i drawn = _mm256_mask_i32gather_epi32(zero, (const int*)pile,
+                                                _mm256_add_epi32(pileBase, g.cursor), draw, 4);
+    __m256i drawnShift = _mm256_sub_epi32(_mm256_add_epi32(drawn, drawn), _mm256_set1_epi32(2));
+    __m256i drawnCount = _mm256_add_epi32(
+        _mm256_and_si256(_mm256_srlv_epi32(pHand, drawnShift), three), one);
+    __m256i bookD = _mm256_and_si256(draw, _mm256_cmpeq_epi32(drawnCount, four));
+    __m256i handD = _mm256_or_si256(
+        _mm256_andnot_si256(_mm256_sllv_epi32(three, drawnShift), pHand),
+        _mm256_andnot_si256(bookD, _mm256_sllv_epi32(drawnCount, drawnShift)));
+    __m256i again = _mm256_cmpeq_epi32(drawnShift, shift);
+
+    // Merge the outcomes
+    pHand = _mm256_blendv_epi8(_mm256_blendv_epi8(pHand, handT, transfer), handD, draw);
+    oHand = _mm256_blendv_epi8(oHand, _mm256_andnot_si256(field, oHand), transfer);
+    pDenied = _mm256_blendv_epi8(pDenied,
+                                 _mm256_or_si256(pDenied, _mm256_sllv_epi32(one, shift)), noDraw);
+    pDenied = _mm256_andnot_si256(_mm256_or_si256(transfer, draw), pDenied);
+    pBooks = _mm256_sub_epi32(pBooks, _mm256_or_si256(bookT, bookD));
+    __m256i pass = _mm256_or_si256(_mm256_or_si256(skip, noDraw), _mm256_andnot_si256(again, draw));
+
+    g.hand0 = _mm256_blendv_epi8(pHand, oHand, second);
+    g.hand1 = _mm256_blendv_epi8(oHand, pHand, second);
+    g.denied0 = _mm256_blendv_epi8(pDenied, g.denied0, second);
+    g.denied1 = _mm256_blendv_epi8(g.denied1, pDenied, second);
+    g.books0 = _mm256_blendv_epi8(pBooks, g.books0, second);
+    g.books1 = _mm256_blendv_epi8(g.books1, pBooks, second);
+    g.turn = _mm256_xor_si256(g.turn, _mm256_and_si256(pass, one));
+    g.cursor = _mm256_sub_epi32(g.cursor, draw);
+    g.steps = _mm256_sub_epi32(g.steps, go);
+    g.over = _mm256_or_si256(g.over, end);
+    return end;
+}
+
+__attribute__((target("avx2")))
+void stepAvx2(BatchEngine::Lanes& s) {
+    static_assert(BatchEngine::LANES == 2 * BatchEngine::GROUP, "two interleaved groups");
+    GroupState a, b;
+    loadGroup(a, s, 0);
+    loadGroup(b, s, BatchEngine::GROUP);
+    const __m256i baseA = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                                             _mm256_set1_epi32(BatchEngine::DECK));
+    const __m256i baseB = _mm256_add_epi32(baseA,
+                                           _mm256_set1_epi32(BatchEngine::GROUP * BatchEngine::DECK));
+    for (;;) {
+        __m256i playing = _mm256_or_si256(_mm256_andnot_si256(a.over, a.live),
+                                          _mm256_andnot_si256(b.over, b.live));
+        if (_mm256_testz_si256(playing, playing)) {
+            break;
+        }
+        __m256i ended = _mm256_or_si256(stepGroup(a, s.pile, baseA), stepGroup(b, s.pile, baseB));
+        if (!_mm256_testz_si256(ended, ended)) {
+            break;
+        }
+    }
+    storeGroup(a, s, 0);
+    storeGroup(b, s, BatchEngine::GROUP);
+}
+
+#endif // BATCH_X86
+
+} // namespace
+
+BatchEngine::BatchEngine() : m_simd(false), m_cache(nullptr) {
+    std::memset(&m_lanes, 0, sizeof(m_lanes));
+    std::fill(m_game, m_game + LANES, -1);
+    setSimd(true);
+}
+
+void BatchEngine::setSimd(bool enabled) {
+#ifdef BATCH_X86
+    m_simd = enabled && __builtin_cpu_supports("avx2");
+#else
+    (void)enabled;
+    m_simd = false;
+#endif
+}
+
+// Same deck order, generator sequence and shuffle as GameEngine::startNewGame
+void BatchEngine::deal(int lane, unsigned int seed) {
+    Card deck[DECK];
+    int n = 0;
+    for (int suit = 0; suit < 4; ++suit) {
+        for (int rank = 1; rank <= 13; ++rank) {
+            deck[n++] = Card{rank, suit};
+        }
+    }
+    DeckRng rng(seed);
+    std::shuffle(deck, deck + DECK, rng);
+
+    int32_t* pile = &m_lanes.pile[lane * DECK];
+    for (int i = 0; i < DECK; ++i) {
+        pile[i] = deck[i].rank;
+    }
+    for (int player = 0; player < 2; ++player) {
+        int counts[14] = {};
+        for (int i = 0; i < HAND_SIZE; ++i) {
+            ++counts[pile[player * HAND_SIZE + i]];
+        }
+        int32_t hand = 0;
+        int books = 0;
+        for (int r = 1; r <= 13; ++r) {
+            if (counts[r] == 4) {
+                ++books;
+            } else {
+                hand |= counts[r] << (2 * (r - 1));
+            }
+        }
+        m_lanes.hand[player][lane] = hand;
+        m_lanes.denied[player][lane] = 0;
+        m_lanes.books[player][lane] = books;
+    }
+    m_lanes.turn[lane] = 0;
+    m_lanes.cursor[lane] = 2 * HAND_SIZE;
+    m_lanes.steps[lane] = 0;
+    m_lanes.over[lane] = 0;
+    m_lanes.live[lane] = -1;
+}
+
+// Deal the next game that is not already cached into lane; false (and the
+// lane left idle) once there are none
+bool BatchEngine::startNext(int lane, unsigned int firstSeed, int count, int& next,
+                            std::vector<GameResult>& results) {
+    while (next < count) {
+        int game = next++;
+        deal(lane, firstSeed + game);
+        DealOutcome outcome;
+        if (m_cache && m_cache->find(DealKey::fromRanks(&m_lanes.pile[lane * DECK]), outcome)) {
+            results[game] = GameResult{firstSeed + game, outcome.books1, outcome.books2,
+                                       outcome.steps};
+            continue;
+        }
+        m_game[lane] = game;
+        return true;
+    }
+    m_lanes.live[lane] = 0;
+    return false;
+}
+
+void BatchEngine::run(unsigned int firstSeed, int count, std::vector<GameResult>& results) {
+    results.resize(count);
+    int next = 0;
+    for (int lane = 0; lane < LANES; ++lane) {
+        startNext(lane, firstSeed, count, next, results);
+    }
+
+    for (;;) {
+#ifdef BATCH_X86
+        if (m_simd) {
+            stepAvx2(m_lanes);
+        } else {
+            stepPortable(m_lanes);
+        }
+#else
+        stepPortable(m_lanes);
+#endif
+        bool busy = false;
+        for (int lane = 0; lane < LANES; ++lane) {
+            if (!m_lanes.live[lane]) {
+                continue;
+            }
+            if (m_lanes.over[lane]) {
+                int game = m_game[lane];
+                results[game] = GameResult{firstSeed + game, m_lanes.books[0][lane],
+                                           m_lanes.books[1][lane], m_lanes.steps[lane]};
+                if (m_cache) {
+                    m_cache->insert(DealKey::fromRanks(&m_lanes.pile[lane * DECK]),
+                                    DealOutcome{(int16_t)m_lanes.books[0][lane],
+                                                (int16_t)m_lanes.books[1][lane],
+                                                m_lanes.steps[lane]});
+                }
+                if (!startNext(lane, firstSeed, count, next, results)) {
+                    continue;
+                }
+            }
+            busy = true;
+        }
+        if (!busy) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef BATCHENGINE_H
+#define BATCHENGINE_H
+
+#include <cstdint>
+#include <vector>
+#include "GameEngine.h"
+
+class DealCache;
+
+// Outcome of one game, enough to check a batch run against GameEngine
+struct GameResult {
+    unsigned int seed;
+    int books1;
+    int books2;
+    int steps; // stepGame() calls that returned true
+};
+
+// Plays many headless AI vs AI games in lockstep, LANES at a time, for
+// bulk simulation. Results match GameEngine game for game: decks come from
+// the same generator and shuffle, and the turn rules are the same.
+//
+// Suits never influence play, so each hand is reduced to 2-bit rank counts
+// packed into one 32-bit word (rank r at bits 2(r-1); a fourth card makes a
+// book and leaves the hand at once, so 3 is the largest count kept). The
+// games are stored structure-of-arrays and one AVX2 pass advances eight of
+// them by a turn, with per-lane masks standing in for the engine's branches.
+// A portable path with identical results is used without AVX2.
+class BatchEngine {
+public:
+    static const int GROUP = 8;  // Games per 256-bit vector
+    static const int LANES = 16; // Two groups interleaved to hide latency
+    static const int DECK = 52;
+
+    BatchEngine();
+
+    // AVX2 is used when the CPU has it unless disabled here
+    void setSimd(bool enabled);
+    bool simdEnabled() const { return m_simd; }
+
+    // Look every deal up in this cache first and add the outcomes of those
+    // played; null (the default) plays everything
+    void setCache(DealCache* cache) { m_cache = cache; }
+
+    // Play the games seeded firstSeed .. firstSeed + count - 1; results[i]
+    // is the game seeded firstSeed + i. A finished lane is refilled with
+    // the next game straight away, so all lanes stay busy until the tail.
+    void run(unsigned int firstSeed, int count, std::vector<GameResult>& results);
+
+    // Per-lane game state. hand/denied/books are indexed by player
+    // (0 = AI1); masks are all ones (true) or zero.
+    struct alignas(32) Lanes {
+        int32_t hand[2][LANES];   // Packed rank counts
+        int32_t denied[2][LANES]; // Bit 2(r-1): the opponent has no rank r
+        int32_t books[2][LANES];
+        int32_t turn[LANES];      // Player to move
+        int32_t cursor[LANES];    // Next card in this lane's pile
+        int32_t steps[LANES];
+        int32_t over[LANES];      // Mask: game ended
+        int32_t live[LANES];      // Mask: lane holds a game
+        int32_t pile[LANES * DECK]; // Shuffled ranks, dealt from the front
+    };
+
+private:
+    Lanes m_lanes;
+    int m_game[LANES]; // Index into the results of each lane's game
+    bool m_simd;
+    DealCache* m_cache;
+
+    void deal(int lane, unsigned int seed);
+    bool startNext(int lane, unsigned int firstSeed, int count, int& next,
+                   std::vector<GameResult>& results);
+};
+
+#endif // BATCHENGINE_H
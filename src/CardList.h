@@ -0,0 +1,66 @@
+#ifndef CARDLIST_H
+#define CARDLIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+struct Card {
+    int rank; // 1-13 (1=A, 11=J, 12=Q, 13=K)
+    int suit; // 0=Hearts, 1=Diamonds, 2=Clubs, 3=Spades
+};
+
+bool operator<(const Card& a, const Card& b);
+
+// Up to a full deck of cards stored inline, with the subset of the
+// std::vector interface the engine and its views use. Nothing lives on the
+// heap, so an engine holding a few of these is one flat block: clearing
+// resets a count, copying is a memcpy, and an array of engines keeps every
+// table's cards contiguous.
+//
+// Adding beyond CAPACITY is a logic error (a game only ever moves the 52
+// cards it dealt) and is not checked.
+class CardList {
+public:
+    static const int CAPACITY = 52;
+
+    typedef Card value_type;
+    typedef Card* iterator;
+    typedef const Card* const_iterator;
+
+    CardList() : m_size(0) {}
+
+    iterator begin() { return m_cards; }
+    iterator end() { return m_cards + m_size; }
+    const_iterator begin() const { return m_cards; }
+    const_iterator end() const { return m_cards + m_size; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    Card& operator[](size_t i) { return m_cards[i]; }
+    const Card& operator[](size_t i) const { return m_cards[i]; }
+    const Card& front() const { return m_cards[0]; }
+    const Card& back() const { return m_cards[m_size - 1]; }
+
+    void clear() { m_size = 0; }
+    void push_back(const Card& card) { m_cards[m_size++] = card; }
+
+    void assign(const_iterator first, const_iterator last) {
+        m_size = (uint8_t)(last - first);
+        std::memmove(m_cards, first, m_size * sizeof(Card));
+    }
+
+    iterator erase(iterator first, iterator last) {
+        std::memmove(first, last, (end() - last) * sizeof(Card));
+        m_size = (uint8_t)(m_size - (last - first));
+        return first;
+    }
+    iterator erase(iterator pos) { return erase(pos, pos + 1); }
+
+private:
+    Card m_cards[CAPACITY];
+    uint8_t m_size;
+};
+
+#endif // CARDLIST_H
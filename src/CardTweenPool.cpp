@@ -0,0 +1,113 @@
+#include "CardTweenPool.h"
+#include <algorithm>
+
+const float CardTweenPool::TIMESTEP = 1.0f / 120.0f;
+
+CardTweenPool::CardTweenPool()
+    : m_count(0), m_accumulator(0.0f), m_tail(0.0f) {
+}
+
+bool CardTweenPool::add(const Card& card, bool faceDown, int startX, int startY,
+                        int endX, int endY, float delay, float duration,
+                        int destHand, int destIndex) {
+    if (m_count >= CAPACITY) {
+        return false;
+    }
+
+    int i = m_count++;
+    m_startX[i] = (float)startX;
+    m_startY[i] = (float)startY;
+    m_deltaX[i] = (float)(endX - startX);
+    m_deltaY[i] = (float)(endY - startY);
+    m_time[i] = -delay;
+    m_invDuration[i] = 1.0f / std::max(duration, TIMESTEP);
+    m_curX[i] = m_startX[i];
+    m_curY[i] = m_startY[i];
+    m_rank[i] = (int8_t)card.rank;
+    m_suit[i] = (int8_t)card.suit;
+    m_faceDown[i] = faceDown ? 1 : 0;
+    m_destHand[i] = (int8_t)destHand;
+    m_destIndex[i] = (int8_t)destIndex;
+
+    m_tail = std::max(m_tail, delay + duration);
+    return true;
+}
+
+void CardTweenPool::advance(float deltaTime) {
+    m_tail = std::max(0.0f, m_tail - deltaTime);
+    if (m_count == 0) {
+        m_accumulator = 0.0f;
+        return;
+    }
+
+    // Consume whole fixed steps; tweens are linear in time so all pending
+    // steps are applied in a single pass
+    m_accumulator += deltaTime;
+    int steps = (int)(m_accumulator / TIMESTEP);
+    if (steps == 0) {
+        return;
+    }
+    float dt = steps * TIMESTEP;
+    m_accumulator -= dt;
+
+    for (int i = 0; i < m_count; ++i) {
+        float time = m_time[i] + dt;
+        m_time[i] = time;
+
+        // Ease-in-out interpolation
+        float t = std::min(1.0f, std::max(0.0f, time * m_invDuration[i]));
+        float eased = t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
+        m_curX[i] = m_startX[i] + m_deltaX[i] * eased;
+        m_curY[i] = m_startY[i] + m_deltaY[i] * eased;
+    }
+
+    // Remove completed tweens
+    for (int i = 0; i < m_count; ) {
+        if (m_time[i] * m_invDuration[i] >= 1.0f) {
+            removeAt(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void CardTweenPool::clear() {
+    m_count = 0;
+    m_accumulator = 0.0f;
+    m_tail = 0.0f;
+}
+
+uint64_t CardTweenPool::incomingSlots(int hand) const {
+    uint64_t mask = 0;
+    for (int i = 0; i < m_count; ++i) {
+        if (m_destHand[i] == hand && m_destIndex[i] >= 0) {
+            mask |= (uint64_t)1 << m_destIndex[i];
+        }
+    }
+    return mask;
+}
+
+void CardTweenPool::releaseSlots(int hand) {
+    for (int i = 0; i < m_count; ++i) {
+        if (m_destHand[i] == hand) {
+            m_destIndex[i] = -1;
+        }
+    }
+}
+
+void CardTweenPool::removeAt(int i) {
+    int last = --m_count;
+    m_startX[i] = m_startX[last];
+    m_startY[i] = m_startY[last];
+    m_deltaX[i] = m_deltaX[last];
+    m_deltaY[i] = m_deltaY[last];
+    m_time[i] = m_time[last];
+    m_invDuration[i] = m_invDuration[last];
+    m_curX[i] = m_curX[last];
+    m_curY[i] = m_curY[last];
+    m_rank[i] = m_rank[last];
+    m_suit[i] = m_suit[last];
+    m_faceDown[i] = m_faceDown[last];
+    m_destHand[i] = m_destHand[last];
+    m_destIndex[i] = m_destIndex[last];
+}
@@ -0,0 +1,67 @@
+#ifndef CARDTWEENPOOL_H
+#define CARDTWEENPOOL_H
+
+#include <cstdint>
+#include "GameEngine.h"
+
+// Fixed-capacity pool of card tweens stored as structure-of-arrays.
+// Active tweens are kept densely packed at the front of every array so a
+// frame update is one branch-free pass over contiguous floats followed by a
+// swap-remove compaction of the finished entries.
+class CardTweenPool {
+public:
+    static const int CAPACITY = 512;
+    static const float TIMESTEP; // Fixed simulation step in seconds
+
+    CardTweenPool();
+
+    // Schedule a tween that starts after `delay` seconds. Returns false when
+    // the pool is full (the card then simply appears at its destination).
+    bool add(const Card& card, bool faceDown, int startX, int startY,
+             int endX, int endY, float delay, float duration,
+             int destHand = -1, int destIndex = -1);
+    void advance(float deltaTime);
+    void clear();
+
+    int size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    // Seconds until every scheduled tween has finished
+    float timeUntilIdle() const { return m_tail; }
+
+    // Per-tween read access for rendering, 0 <= i < size()
+    int x(int i) const { return (int)m_curX[i]; }
+    int y(int i) const { return (int)m_curY[i]; }
+    Card card(int i) const { return Card{m_rank[i], m_suit[i]}; }
+    bool faceDown(int i) const { return m_faceDown[i] != 0; }
+
+    // Bitmask of destination slots (bit n = card index n) of `hand` that
+    // still have a tween in flight towards them
+    uint64_t incomingSlots(int hand) const;
+
+    // Forget destination slots of `hand` after its layout has shifted
+    void releaseSlots(int hand);
+
+private:
+    float m_startX[CAPACITY];
+    float m_startY[CAPACITY];
+    float m_deltaX[CAPACITY];
+    float m_deltaY[CAPACITY];
+    float m_time[CAPACITY];        // Negative while waiting for the delay
+    float m_invDuration[CAPACITY];
+    float m_curX[CAPACITY];
+    float m_curY[CAPACITY];
+    int8_t m_rank[CAPACITY];
+    int8_t m_suit[CAPACITY];
+    uint8_t m_faceDown[CAPACITY];
+    int8_t m_destHand[CAPACITY];
+    int8_t m_destIndex[CAPACITY];
+
+    int m_count;
+    float m_accumulator;
+    float m_tail;
+
+    void removeAt(int i);
+};
+
+#endif // CARDTWEENPOOL_H
@@ -0,0 +1,106 @@
+#include "DealCache.h"
+#include <algorithm>
+
+namespace {
+
+const int DECK_SIZE = 52;
+const int HAND_SIZE = 7;
+const int PROBES = 16; // Slots tried per key before giving up
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    return x ^ (x >> 33);
+}
+
+} // namespace
+
+DealKey DealKey::fromDeck(const Card* deck) {
+    int32_t ranks[DECK_SIZE];
+    for (int i = 0; i < DECK_SIZE; ++i) {
+        ranks[i] = deck[i].rank;
+    }
+    return fromRanks(ranks);
+}
+
+DealKey DealKey::fromRanks(const int32_t* ranks) {
+    int32_t sorted[DECK_SIZE];
+    std::copy(ranks, ranks + DECK_SIZE, sorted);
+    std::sort(sorted, sorted + HAND_SIZE);
+    std::sort(sorted + HAND_SIZE, sorted + 2 * HAND_SIZE);
+
+    DealKey key = {{0, 0, 0, 0}};
+    for (int i = 0; i < DECK_SIZE; ++i) {
+        key.words[i / 16] |= (uint64_t)sorted[i] << (4 * (i % 16));
+    }
+    return key;
+}
+
+bool DealKey::operator==(const DealKey& other) const {
+    return words[0] == other.words[0] && words[1] == other.words[1] &&
+           words[2] == other.words[2] && words[3] == other.words[3];
+}
+
+uint64_t DealKey::hash() const {
+    return mix(words[0] ^ mix(words[1] ^ mix(words[2] ^ mix(words[3]))));
+}
+
+DealCache::DealCache(size_t capacity)
+    : m_entries(0), m_lookups(0), m_hits(0), m_dropped(0) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    m_slots.reset(new Slot[size]);
+    m_mask = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        m_slots[i].state.store(EMPTY, std::memory_order_relaxed);
+    }
+}
+
+bool DealCache::find(const DealKey& key, DealOutcome& outcome) const {
+    m_lookups.fetch_add(1, std::memory_order_relaxed);
+    size_t index = key.hash() & m_mask;
+    for (int probe = 0; probe < PROBES; ++probe) {
+        const Slot& slot = m_slots[(index + probe) & m_mask];
+        uint32_t state = slot.state.load(std::memory_order_acquire);
+        if (state == EMPTY) {
+            return false; // Slots are never freed, so the key is not further on
+        }
+        if (state == READY && slot.key == key) {
+            outcome = slot.outcome;
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void DealCache::insert(const DealKey& key, const DealOutcome& outcome) {
+    size_t index = key.hash() & m_mask;
+    for (int probe = 0; probe < PROBES; ++probe) {
+        Slot& slot = m_slots[(index + probe) & m_mask];
+        uint32_t state = slot.state.load(std::memory_order_acquire);
+        if (state == EMPTY &&
+            slot.state.compare_exchange_strong(state, WRITING, std::memory_order_acquire)) {
+            slot.key = key;
+            slot.outcome = outcome;
+            slot.state.store(READY, std::memory_order_release);
+            m_entries.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // Lost the race or occupied; a slot being written may hold the same
+        // key, in which case a duplicate further on is harmless
+        if (state == READY && slot.key == key) {
+            return;
+        }
+    }
+    m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+double DealCache::hitRate() const {
+    uint64_t total = lookups();
+    return total > 0 ? (double)hits() / total : 0.0;
+}
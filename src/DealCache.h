@@ -0,0 +1,69 @@
+#ifndef DEALCACHE_H
+#define DEALCACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "CardList.h"
+
+// Canonical form of a deal. Play depends on ranks only (suits just change
+// the sort order of a hand) and each hand is a multiset, so two decks give
+// the same game exactly when both hands hold the same ranks and the piles
+// hold the same rank sequence. The key is those 52 ranks, 4 bits each,
+// with each hand's ranks sorted.
+struct DealKey {
+    uint64_t words[4];
+
+    // deck[0..51] in dealing order, as BasicGameEngine::startNewGame(deck) takes it
+    static DealKey fromDeck(const Card* deck);
+    static DealKey fromRanks(const int32_t* ranks);
+
+    bool operator==(const DealKey& other) const;
+    uint64_t hash() const;
+};
+
+struct DealOutcome {
+    int16_t books1;
+    int16_t books2;
+    int32_t steps; // stepGame() calls that returned true
+};
+
+// Fixed-size, insert-only map from canonical deals to their outcome,
+// shared by any number of threads without locks. A slot is claimed with a
+// compare-and-swap, filled, then published with a release store, and is
+// never rewritten, so readers need a single acquire load. Once the probe
+// window of a key is full further outcomes are simply not cached.
+class DealCache {
+public:
+    explicit DealCache(size_t capacity); // Rounded up to a power of two
+
+    bool find(const DealKey& key, DealOutcome& outcome) const;
+    void insert(const DealKey& key, const DealOutcome& outcome);
+
+    size_t capacity() const { return m_mask + 1; }
+    size_t memoryBytes() const { return capacity() * sizeof(Slot); }
+    uint64_t entries() const { return m_entries.load(std::memory_order_relaxed); }
+    uint64_t lookups() const { return m_lookups.load(std::memory_order_relaxed); }
+    uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    double hitRate() const;
+
+private:
+    enum SlotState : uint32_t { EMPTY, WRITING, READY };
+
+    struct Slot {
+        std::atomic<uint32_t> state;
+        DealOutcome outcome;
+        DealKey key;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_mask;
+    std::atomic<uint64_t> m_entries;
+    mutable std::atomic<uint64_t> m_lookups;
+    mutable std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_dropped;
+};
+
+#endif // DEALCACHE_H
@@ -1,25 +1,69 @@
 #include "GameEngine.h"
+#include "LatencyHistogram.h"
+#include "Profiler.h"
+#include "Tracer.h"
 #include <algorithm>
 #include <random>
 #include <iostream>
 
+const char* eventTypeName(EventType type) {
+    switch (type) {
+        case EventType::GAME_STARTED:      return "GAME_STARTED";
+        case EventType::TURN_STARTED:      return "TURN_STARTED";
+        case EventType::REQUEST_MADE:      return "REQUEST_MADE";
+        case EventType::CARDS_TRANSFERRED: return "CARDS_TRANSFERRED";
+        case EventType::GO_FISH:           return "GO_FISH";
+        case EventType::CARD_DRAWN:        return "CARD_DRAWN";
+        case EventType::BOOK_FORMED:       return "BOOK_FORMED";
+        case EventType::TURN_ENDED:        return "TURN_ENDED";
+        case EventType::GAME_ENDED:        return "GAME_ENDED";
+    }
+    return "UNKNOWN";
+}
+
+namespace {
+
+const char* const PLAYER_NAMES[3] = {"AI1", "AI2", "Tie"};
+
+} // namespace
+
 bool operator<(const Card& a, const Card& b) {
     if (a.rank != b.rank) return a.rank < b.rank;
     return a.suit < b.suit;
 }
 
-GameEngine::GameEngine() 
-    : m_books1(0), m_books2(0), m_turn("AI1"), m_gameState(GameState::NOT_STARTED) {
-    m_deniedRanks["AI1"] = {};
-    m_deniedRanks["AI2"] = {};
+template <class Sink>
+BasicGameEngine<Sink>::BasicGameEngine()
+    : m_books1(0), m_books2(0), m_turn(0), m_winner(-1), m_gameState(GameState::NOT_STARTED),
+      m_hash(0), m_rng(std::random_device()()) {
+    m_deniedRanks[0] = 0;
+    m_deniedRanks[1] = 0;
+    m_bookRanks[0] = 0;
+    m_bookRanks[1] = 0;
+    m_choosers[0] = nullptr;
+    m_choosers[1] = nullptr;
 }
 
-GameEngine::~GameEngine() {
+template <class Sink>
+BasicGameEngine<Sink>::~BasicGameEngine() {
 }
 
-void GameEngine::startNewGame() {
+template <class Sink>
+void BasicGameEngine<Sink>::startNewGame() {
     reset();
     initializeDeck();
+    beginGame();
+}
+
+template <class Sink>
+void BasicGameEngine<Sink>::startNewGame(const CardList& deck) {
+    reset();
+    m_drawPile = deck;
+    beginGame();
+}
+
+template <class Sink>
+void BasicGameEngine<Sink>::beginGame() {
     dealCards();
     
     // Check for initial books
@@ -27,44 +71,83 @@ void GameEngine::startNewGame() {
     m_books2 += checkBooks(m_hand2);
     
     m_gameState = GameState::PLAYING;
-    m_turn = "AI1";
+    m_turn = 0;
+    m_hash = Zobrist::hash(packPosition());
     
-    GameEvent event;
-    event.type = EventType::GAME_STARTED;
-    event.message = "New game started!";
-    emitEvent(event);
+    emitEvent(EventType::GAME_STARTED);
 }
 
-void GameEngine::reset() {
+template <class Sink>
+void BasicGameEngine<Sink>::reset() {
     m_hand1.clear();
     m_hand2.clear();
     m_drawPile.clear();
     m_books1 = 0;
     m_books2 = 0;
-    m_turn = "AI1";
-    m_winner = "";
+    m_turn = 0;
+    m_winner = -1;
     m_gameState = GameState::NOT_STARTED;
-    m_deniedRanks["AI1"].clear();
-    m_deniedRanks["AI2"].clear();
-    m_eventHistory.clear();
+    m_deniedRanks[0] = 0;
+    m_deniedRanks[1] = 0;
+    m_bookRanks[0] = 0;
+    m_bookRanks[1] = 0;
+    m_hash = 0;
+    m_beliefs.reset();
+    m_sink.reset();
 }
 
-void GameEngine::initializeDeck() {
-    std::vector<Card> deck;
+template <class Sink>
+GameSnapshot BasicGameEngine<Sink>::snapshot() const {
+    GameSnapshot snapshot;
+    snapshot.hand1 = m_hand1;
+    snapshot.hand2 = m_hand2;
+    snapshot.drawPile = m_drawPile;
+    snapshot.books1 = m_books1;
+    snapshot.books2 = m_books2;
+    snapshot.turn = m_turn;
+    snapshot.winner = m_winner;
+    snapshot.gameState = m_gameState;
+    snapshot.deniedRanks[0] = m_deniedRanks[0];
+    snapshot.deniedRanks[1] = m_deniedRanks[1];
+    snapshot.bookRanks[0] = m_bookRanks[0];
+    snapshot.bookRanks[1] = m_bookRanks[1];
+    snapshot.hash = m_hash;
+    snapshot.beliefs = m_beliefs;
+    return snapshot;
+}
+
+template <class Sink>
+void BasicGameEngine<Sink>::restore(const GameSnapshot& snapshot) {
+    m_hand1 = snapshot.hand1;
+    m_hand2 = snapshot.hand2;
+    m_drawPile = snapshot.drawPile;
+    m_books1 = snapshot.books1;
+    m_books2 = snapshot.books2;
+    m_turn = snapshot.turn;
+    m_winner = snapshot.winner;
+    m_gameState = snapshot.gameState;
+    m_deniedRanks[0] = snapshot.deniedRanks[0];
+    m_deniedRanks[1] = snapshot.deniedRanks[1];
+    m_bookRanks[0] = snapshot.bookRanks[0];
+    m_bookRanks[1] = snapshot.bookRanks[1];
+    m_hash = snapshot.hash;
+    m_beliefs = snapshot.beliefs;
+}
+
+template <class Sink>
+void BasicGameEngine<Sink>::initializeDeck() {
+    m_drawPile.clear();
     for (int suit = 0; suit < 4; ++suit) {
         for (int rank = 1; rank <= 13; ++rank) {
-            deck.push_back({rank, suit});
+            m_drawPile.push_back({rank, suit});
         }
     }
     
-    std::random_device rd;
-    std::mt19937 g(rd());
-    std::shuffle(deck.begin(), deck.end(), g);
-    
-    m_drawPile = deck;
+    std::shuffle(m_drawPile.begin(), m_drawPile.end(), m_rng);
 }
 
-void GameEngine::dealCards() {
+template <class Sink>
+void BasicGameEngine<Sink>::dealCards() {
     // Deal 7 cards to each player
     m_hand1.assign(m_drawPile.begin(), m_drawPile.begin() + 7);
     m_hand2.assign(m_drawPile.begin() + 7, m_drawPile.begin() + 14);
@@ -74,27 +157,38 @@ void GameEngine::dealCards() {
     std::sort(m_hand2.begin(), m_hand2.end());
 }
 
-int GameEngine::checkBooks(std::vector<Card>& hand) {
+template <class Sink>
+int BasicGameEngine<Sink>::checkBooks(CardList& hand) {
+    PROFILE_SCOPE(ENGINE_BOOKS);
+    int player = &hand == &m_hand1 ? 0 : 1;
     int newBooks = 0;
     for (int r = 1; r <= 13; ++r) {
-        if (countCards(hand, r) == 4) {
-            // Remove the 4 cards of rank r
-            hand.erase(std::remove_if(hand.begin(), hand.end(), 
-                [r](const Card& c) { return c.rank == r; }), hand.end());
+        if (formBook(player, hand, r)) {
             ++newBooks;
-            
-            GameEvent event;
-            event.type = EventType::BOOK_FORMED;
-            event.rank = r;
-            event.message = "Book of " + pluralRank(r) + " formed!";
-            emitEvent(event);
         }
     }
     std::sort(hand.begin(), hand.end());
     return newBooks;
 }
 
-int GameEngine::countCards(const std::vector<Card>& hand, int rank) const {
+// Books rank if the hand holds all four; the caller counts the book
+template <class Sink>
+bool BasicGameEngine<Sink>::formBook(int player, CardList& hand, int rank) {
+    if (countCards(hand, rank) != 4) {
+        return false;
+    }
+    // Remove the 4 cards of the rank
+    hand.erase(std::remove_if(hand.begin(), hand.end(), 
+        [rank](const Card& c) { return c.rank == rank; }), hand.end());
+    m_bookRanks[player] |= (uint16_t)(1u << rank);
+    m_hash ^= Zobrist::hand(player, rank, 4) ^ Zobrist::book(player, rank);
+    
+    emitEvent(EventType::BOOK_FORMED, player, -1, rank);
+    return true;
+}
+
+template <class Sink>
+int BasicGameEngine<Sink>::countCards(const CardList& hand, int rank) const {
     int count = 0;
     for (const auto& c : hand) {
         if (c.rank == rank) ++count;
@@ -102,192 +196,335 @@ int GameEngine::countCards(const std::vector<Card>& hand, int rank) const {
     return count;
 }
 
-int GameEngine::chooseRank(const std::vector<Card>& hand, const std::set<int>& denied) const {
-    std::set<int> available;
+// Lowest rank in hand the opponent has not already denied, 0 if none
+template <class Sink>
+int BasicGameEngine<Sink>::chooseRank(const CardList& hand, uint16_t denied) const {
+    int best = 0;
     for (const auto& c : hand) {
-        if (denied.find(c.rank) == denied.end()) {
-            available.insert(c.rank);
+        if (!(denied & (1u << c.rank)) && (best == 0 || c.rank < best)) {
+            best = c.rank;
         }
     }
-    if (available.empty()) {
-        return 0;
-    }
-    return *available.begin();
+    return best;
 }
 
-bool GameEngine::validateRequest(const std::vector<Card>& hand, int rank) const {
+template <class Sink>
+bool BasicGameEngine<Sink>::validateRequest(const CardList& hand, int rank) const {
     for (const auto& c : hand) {
         if (c.rank == rank) return true;
     }
     return false;
 }
 
-void GameEngine::processRequest(const std::string& player, const std::string& opponent, int rank,
-                                std::vector<Card>& pHand, std::vector<Card>& oHand, int& pBooks) {
+template <class Sink>
+void BasicGameEngine<Sink>::processRequest(int player, int rank,
+                                CardList& pHand, CardList& oHand, int& pBooks) {
+    PROFILE_SCOPE(ENGINE_TRANSFER);
     int num = countCards(oHand, rank);
     
-    GameEvent event;
-    event.type = EventType::CARDS_TRANSFERRED;
-    event.player = player;
-    event.opponent = opponent;
-    event.rank = rank;
-    event.count = num;
-    event.message = opponent + " gives " + std::to_string(num) + " " + pluralRank(rank) + " to " + player;
-    emitEvent(event);
+    emitEvent(EventType::CARDS_TRANSFERRED, player, 1 - player, rank, num);
+    transferCards(player, rank, num, pHand, oHand);
     
-    // Transfer cards
-    std::vector<Card> transfer;
-    for (auto it = oHand.begin(); it != oHand.end(); ) {
-        if (it->rank == rank) {
-            transfer.push_back(*it);
-            it = oHand.erase(it);
-        } else {
-            ++it;
-        }
-    }
+    pBooks += checkBooks(pHand);
+    clearDenied(player);
+}
+
+// Moves the num cards of rank from oHand to pHand; no event
+template <class Sink>
+void BasicGameEngine<Sink>::transferCards(int player, int rank, int num,
+                                          CardList& pHand, CardList& oHand) {
+    int held = countCards(pHand, rank);
+    m_hash ^= Zobrist::hand(player, rank, held) ^ Zobrist::hand(player, rank, held + num) ^
+              Zobrist::hand(1 - player, rank, num);
     
-    for (const auto& c : transfer) {
-        pHand.push_back(c);
+    for (const auto& c : oHand) {
+        if (c.rank == rank) {
+            pHand.push_back(c);
+        }
     }
+    oHand.erase(std::remove_if(oHand.begin(), oHand.end(),
+        [rank](const Card& c) { return c.rank == rank; }), oHand.end());
     
     std::sort(pHand.begin(), pHand.end());
     std::sort(oHand.begin(), oHand.end());
+}
+
+// Top of the pile into the hand; no event
+template <class Sink>
+Card BasicGameEngine<Sink>::drawCard(int player, CardList& hand) {
+    Card card = m_drawPile.front();
+    m_drawPile.erase(m_drawPile.begin());
+    int held = countCards(hand, card.rank);
+    m_hash ^= Zobrist::hand(player, card.rank, held) ^ Zobrist::hand(player, card.rank, held + 1);
+    hand.push_back(card);
+    std::sort(hand.begin(), hand.end());
+    return card;
+}
+
+// The rank player asks for this turn, 0 to pass
+template <class Sink>
+int BasicGameEngine<Sink>::chooseRequest(int player, const CardList& pHand,
+                                         const CardList& oHand, int pBooks) {
+    int o = 1 - player;
+    int r = chooseRank(pHand, m_deniedRanks[player]);
+    if (r != 0 && m_choosers[player]) {
+        TurnView view = {pHand, m_deniedRanks[player], m_beliefs.holds(o), m_beliefs.mayHold(o),
+                         (int)oHand.size(), (int)m_drawPile.size(), pBooks,
+                         player == 0 ? m_books2 : m_books1};
+        int choice = m_choosers[player](view);
+        if (choice >= 1 && choice <= 13 && !(m_deniedRanks[player] & (1u << choice)) &&
+            validateRequest(pHand, choice)) {
+            r = choice;
+        }
+    }
+    if (r != 0 && !validateRequest(pHand, r)) {
+        r = 0;
+    }
+    return r;
+}
+
+template <class Sink>
+void BasicGameEngine<Sink>::finishGame() {
+    if (m_books1 > m_books2) {
+        m_winner = 0;
+    } else if (m_books2 > m_books1) {
+        m_winner = 1;
+    } else {
+        m_winner = 2;
+    }
     
-    pBooks += checkBooks(pHand);
-    m_deniedRanks[player].clear();
+    m_gameState = GameState::GAME_OVER;
+    
+    emitEvent(EventType::GAME_ENDED, m_winner);
 }
 
-bool GameEngine::noValidMoves() const {
-    int r1 = chooseRank(m_hand1, m_deniedRanks.at("AI1"));
-    int r2 = chooseRank(m_hand2, m_deniedRanks.at("AI2"));
+template <class Sink>
+bool BasicGameEngine<Sink>::noValidMoves() const {
+    int r1 = chooseRank(m_hand1, m_deniedRanks[0]);
+    int r2 = chooseRank(m_hand2, m_deniedRanks[1]);
     return r1 == 0 && r2 == 0;
 }
 
-bool GameEngine::isGameOver() const {
+template <class Sink>
+void BasicGameEngine<Sink>::setTurn(int player) {
+    if (player != m_turn) {
+        m_hash ^= Zobrist::turn();
+        m_turn = player;
+    }
+}
+
+template <class Sink>
+void BasicGameEngine<Sink>::denyRank(int player, int rank) {
+    uint16_t bit = (uint16_t)(1u << rank);
+    if (!(m_deniedRanks[player] & bit)) {
+        m_deniedRanks[player] |= bit;
+        m_hash ^= Zobrist::denied(player, rank);
+    }
+}
+
+template <class Sink>
+void BasicGameEngine<Sink>::clearDenied(int player) {
+    for (uint16_t bits = m_deniedRanks[player]; bits; bits &= bits - 1) {
+        m_hash ^= Zobrist::denied(player, __builtin_ctz(bits));
+    }
+    m_deniedRanks[player] = 0;
+}
+
+template <class Sink>
+PackedPosition BasicGameEngine<Sink>::packPosition() const {
+    int counts[2][14] = {{0}, {0}};
+    for (const auto& c : m_hand1) {
+        ++counts[0][c.rank];
+    }
+    for (const auto& c : m_hand2) {
+        ++counts[1][c.rank];
+    }
+    return PackedPosition::pack(counts, m_bookRanks, m_deniedRanks, m_turn);
+}
+
+template <class Sink>
+bool BasicGameEngine<Sink>::isGameOver() const {
     return (m_drawPile.empty() && (m_hand1.empty() || m_hand2.empty())) ||
            (m_hand1.empty() && m_hand2.empty()) ||
            (m_drawPile.empty() && noValidMoves());
 }
 
-bool GameEngine::stepGame() {
+template <class Sink>
+bool BasicGameEngine<Sink>::stepGame() {
     if (m_gameState != GameState::PLAYING) {
         return false;
     }
+    PROFILE_SCOPE(ENGINE_STEP);
+    TRACE_SPAN("turn", "engine");
     
     // Check end conditions
-    if (isGameOver()) {
-        if (m_books1 > m_books2) {
-            m_winner = "AI1";
-        } else if (m_books2 > m_books1) {
-            m_winner = "AI2";
-        } else {
-            m_winner = "Tie";
-        }
-        
-        m_gameState = GameState::GAME_OVER;
-        
-        GameEvent event;
-        event.type = EventType::GAME_ENDED;
-        event.message = "Game Over! Winner: " + m_winner;
-        emitEvent(event);
-        
+    bool over;
+    {
+        PROFILE_SCOPE(ENGINE_END_CHECK);
+        over = isGameOver();
+    }
+    if (over) {
+        finishGame();
         return false;
     }
     
-    std::string p = m_turn;
-    std::string o = (p == "AI1" ? "AI2" : "AI1");
-    std::vector<Card>& pHand = (p == "AI1" ? m_hand1 : m_hand2);
-    std::vector<Card>& oHand = (p == "AI1" ? m_hand2 : m_hand1);
-    int& pBooks = (p == "AI1" ? m_books1 : m_books2);
+    int p = m_turn;
+    int o = 1 - p;
+    CardList& pHand = (p == 0 ? m_hand1 : m_hand2);
+    CardList& oHand = (p == 0 ? m_hand2 : m_hand1);
+    int& pBooks = (p == 0 ? m_books1 : m_books2);
     
-    GameEvent turnEvent;
-    turnEvent.type = EventType::TURN_STARTED;
-    turnEvent.player = p;
-    turnEvent.message = p + "'s turn";
-    emitEvent(turnEvent);
+    emitEvent(EventType::TURN_STARTED, p);
     
     if (pHand.empty()) {
-        m_turn = o;
+        setTurn(o);
         return true;
     }
     
-    std::set<int> denied = m_deniedRanks[p];
-    int r = chooseRank(pHand, denied);
+    int r;
+    {
+        PROFILE_SCOPE(ENGINE_CHOOSE);
+        r = chooseRequest(p, pHand, oHand, pBooks);
+    }
     
-    if (r == 0 || !validateRequest(pHand, r)) {
-        m_turn = o;
+    if (r == 0) {
+        setTurn(o);
         return true;
     }
     
-    GameEvent requestEvent;
-    requestEvent.type = EventType::REQUEST_MADE;
-    requestEvent.player = p;
-    requestEvent.opponent = o;
-    requestEvent.rank = r;
-    requestEvent.message = p + " asks " + o + " for " + pluralRank(r);
-    emitEvent(requestEvent);
+    PROFILE_SCOPE(ENGINE_REQUEST);
+    emitEvent(EventType::REQUEST_MADE, p, o, r);
     
     bool hasRank = countCards(oHand, r) > 0;
     
     if (hasRank) {
-        processRequest(p, o, r, pHand, oHand, pBooks);
-        m_turn = p; // Go again
+        processRequest(p, r, pHand, oHand, pBooks);
+        // Still p's turn: go again
     } else {
-        GameEvent goFishEvent;
-        goFishEvent.type = EventType::GO_FISH;
-        goFishEvent.player = p;
-        goFishEvent.opponent = o;
-        goFishEvent.message = o + " says: Go Fish!";
-        emitEvent(goFishEvent);
+        emitEvent(EventType::GO_FISH, p, o);
         
-        m_deniedRanks[p].insert(r);
+        denyRank(p, r);
         
         if (!m_drawPile.empty()) {
-            Card card = m_drawPile.front();
-            m_drawPile.erase(m_drawPile.begin());
-            pHand.push_back(card);
-            std::sort(pHand.begin(), pHand.end());
+            PROFILE_SCOPE(ENGINE_DRAW);
+            Card card = drawCard(p, pHand);
             
-            GameEvent drawEvent;
-            drawEvent.type = EventType::CARD_DRAWN;
-            drawEvent.player = p;
-            drawEvent.drawnCard = card;
-            drawEvent.message = p + " draws: " + cardToStr(card);
-            emitEvent(drawEvent);
+            emitEvent(EventType::CARD_DRAWN, p, -1, 0, 0, card);
             
             pBooks += checkBooks(pHand);
             
-            if (card.rank == r) {
-                m_turn = p; // Go again
-            } else {
-                m_turn = o;
+            if (card.rank != r) {
+                setTurn(o); // Otherwise go again
             }
             
-            m_deniedRanks[p].clear();
+            clearDenied(p);
         } else {
-            m_turn = o;
+            setTurn(o);
         }
     }
     
     return true;
 }
 
-void GameEngine::emitEvent(const GameEvent& event) {
-    m_eventHistory.push_back(event);
-    if (m_eventCallback) {
-        m_eventCallback(event);
+// stepGame() taken apart at its events. Profiling scopes would span the
+// suspensions, so there are none here; callers time each resume instead.
+template <class Sink>
+Generator<EventType> BasicGameEngine<Sink>::playTurn() {
+    if (m_gameState != GameState::PLAYING) {
+        co_return;
     }
+    if (isGameOver()) {
+        finishGame();
+        co_yield EventType::GAME_ENDED;
+        co_return;
+    }
+    
+    int p = m_turn;
+    int o = 1 - p;
+    CardList& pHand = (p == 0 ? m_hand1 : m_hand2);
+    CardList& oHand = (p == 0 ? m_hand2 : m_hand1);
+    int& pBooks = (p == 0 ? m_books1 : m_books2);
+    
+    emitEvent(EventType::TURN_STARTED, p);
+    co_yield EventType::TURN_STARTED;
+    
+    int r = pHand.empty() ? 0 : chooseRequest(p, pHand, oHand, pBooks);
+    if (r == 0) {
+        setTurn(o);
+        co_return;
+    }
+    
+    emitEvent(EventType::REQUEST_MADE, p, o, r);
+    co_yield EventType::REQUEST_MADE;
+    
+    int num = countCards(oHand, r);
+    int drawnRank = r;
+    if (num > 0) {
+        emitEvent(EventType::CARDS_TRANSFERRED, p, o, r, num);
+        transferCards(p, r, num, pHand, oHand);
+        co_yield EventType::CARDS_TRANSFERRED;
+    } else {
+        emitEvent(EventType::GO_FISH, p, o);
+        denyRank(p, r);
+        co_yield EventType::GO_FISH;
+        
+        if (m_drawPile.empty()) {
+            setTurn(o);
+            co_return;
+        }
+        Card card = drawCard(p, pHand);
+        drawnRank = card.rank;
+        emitEvent(EventType::CARD_DRAWN, p, -1, 0, 0, card);
+        co_yield EventType::CARD_DRAWN;
+    }
+    
+    // Removing a book keeps the hand sorted
+    for (int b = 1; b <= 13; ++b) {
+        if (formBook(p, pHand, b)) {
+            ++pBooks;
+            co_yield EventType::BOOK_FORMED;
+        }
+    }
+    if (drawnRank != r) {
+        setTurn(o); // Otherwise go again
+    }
+    clearDenied(p);
 }
 
-const GameEvent& GameEngine::getLastEvent() const {
-    static GameEvent emptyEvent;
-    if (m_eventHistory.empty()) {
-        return emptyEvent;
+// Only reached when the sink wants events
+template <class Sink>
+void BasicGameEngine<Sink>::dispatchEvent(EventType type, int player, int opponent, int rank,
+                                          int count, Card drawnCard) {
+    PROFILE_COUNT(ENGINE_EVENTS, 1);
+    TRACE_INSTANT(eventTypeName(type), "engine", rank);
+    GameEvent event;
+    event.type = type;
+    if (player >= 0) {
+        event.player = PLAYER_NAMES[player];
+    }
+    if (opponent >= 0) {
+        event.opponent = PLAYER_NAMES[opponent];
     }
-    return m_eventHistory.back();
+    event.rank = rank;
+    event.count = count;
+    event.drawnCard = drawnCard;
+    event.timestamp = monotonicNs();
+    PROFILE_SCOPE(ENGINE_DISPATCH);
+    m_sink.emit(event);
 }
 
-std::string GameEngine::rankToStr(int rank) {
+template <class Sink>
+std::string BasicGameEngine<Sink>::getCurrentTurn() const {
+    return PLAYER_NAMES[m_turn];
+}
+
+template <class Sink>
+std::string BasicGameEngine<Sink>::getWinner() const {
+    return m_winner >= 0 ? PLAYER_NAMES[m_winner] : "";
+}
+
+template <class Sink>
+std::string BasicGameEngine<Sink>::rankToStr(int rank) {
     if (rank == 1) return "Ace";
     if (rank == 11) return "Jack";
     if (rank == 12) return "Queen";
@@ -295,7 +532,8 @@ std::string GameEngine::rankToStr(int rank) {
     return std::to_string(rank);
 }
 
-std::string GameEngine::pluralRank(int rank) {
+template <class Sink>
+std::string BasicGameEngine<Sink>::pluralRank(int rank) {
     if (rank == 1) return "Aces";
     if (rank == 11) return "Jacks";
     if (rank == 12) return "Queens";
@@ -303,11 +541,17 @@ std::string GameEngine::pluralRank(int rank) {
     return std::to_string(rank) + "s";
 }
 
-std::string GameEngine::suitToStr(int suit) {
+template <class Sink>
+std::string BasicGameEngine<Sink>::suitToStr(int suit) {
     std::string suits[4] = {"Hearts", "Diamonds", "Clubs", "Spades"};
     return suits[suit];
 }
 
-std::string GameEngine::cardToStr(const Card& card) {
+template <class Sink>
+std::string BasicGameEngine<Sink>::cardToStr(const Card& card) {
     return rankToStr(card.rank) + " of " + suitToStr(card.suit);
-}
\ No newline at end of file
+}
+
+template class BasicGameEngine<NullSink>;
+template class BasicGameEngine<CallbackSink>;
+template class BasicGameEngine<RecordingSink>;
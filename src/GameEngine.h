@@ -1,18 +1,15 @@
 #ifndef GAMEENGINE_H
 #define GAMEENGINE_H
 
-#include <vector>
+#include <cstdint>
 #include <string>
-#include <map>
-#include <set>
 #include <functional>
-
-struct Card {
-    int rank; // 1-13 (1=A, 11=J, 12=Q, 13=K)
-    int suit; // 0=Hearts, 1=Diamonds, 2=Clubs, 3=Spades
-};
-
-bool operator<(const Card& a, const Card& b);
+#include <random>
+#include <vector>
+#include "CardList.h"
+#include "Generator.h"
+#include "Position.h"
+#include "Strategy.h"
 
 enum class GameState {
     NOT_STARTED,
@@ -32,42 +29,180 @@ enum class EventType {
     GAME_ENDED
 };
 
+// Upper-case identifier such as "CARDS_TRANSFERRED"
+const char* eventTypeName(EventType type);
+
 struct GameEvent {
     EventType type;
     std::string player;
     std::string opponent;
-    int rank;
-    int count;
+    int rank = 0;
+    int count = 0;
     Card drawnCard;
-    std::string message;
+    uint64_t timestamp = 0; // monotonicNs() at emission
+};
+
+// What the event stream has revealed about each player's hand, as the
+// opponent can work it out: a request shows the asker holds the rank, a
+// go fish that the asked player lacks it, a transfer that the giver lacks
+// it, a book that the rank is gone, and a draw hides one unknown card.
+// Bit r stands for rank r; every update is a few bit operations.
+class BeliefState {
+public:
+    BeliefState() { reset(); }
+
+    void reset() {
+        m_holds[0] = m_holds[1] = 0;
+        m_mayHold[0] = m_mayHold[1] = ALL_RANKS;
+        m_live = ALL_RANKS;
+        m_lastRequest = 0;
+    }
+
+    void observe(EventType type, int player, int opponent, int rank) {
+        uint16_t bit = (uint16_t)(1u << rank);
+        switch (type) {
+            case EventType::REQUEST_MADE:
+                m_holds[player] |= bit;
+                m_lastRequest = rank;
+                break;
+            case EventType::CARDS_TRANSFERRED:
+                m_holds[player] |= bit;
+                m_holds[opponent] &= (uint16_t)~bit;
+                m_mayHold[opponent] &= (uint16_t)~bit;
+                break;
+            case EventType::GO_FISH: {
+                uint16_t asked = (uint16_t)(1u << m_lastRequest);
+                m_holds[opponent] &= (uint16_t)~asked;
+                m_mayHold[opponent] &= (uint16_t)~asked;
+                break;
+            }
+            case EventType::CARD_DRAWN:
+                m_mayHold[player] = m_live;
+                break;
+            case EventType::BOOK_FORMED:
+                m_live &= (uint16_t)~bit;
+                m_holds[0] &= m_live;
+                m_holds[1] &= m_live;
+                m_mayHold[0] &= m_live;
+                m_mayHold[1] &= m_live;
+                break;
+            default:
+                break;
+        }
+    }
+
+    uint16_t holds(int player) const { return m_holds[player]; }     // Certainly in hand
+    uint16_t mayHold(int player) const { return m_mayHold[player]; } // Not ruled out
+    uint16_t live() const { return m_live; }                         // Not yet booked
+
+private:
+    static const uint16_t ALL_RANKS = 0x3ffe; // Bits 1-13
+
+    uint16_t m_holds[2];
+    uint16_t m_mayHold[2];
+    uint16_t m_live;
+    int m_lastRequest; // GO_FISH refers to the rank just asked for
+};
+
+// Event sinks decide at compile time what the engine does with events.
+// active() gates every emit site: when it is constant false no event is
+// ever built, and when it is false at run time building is skipped.
+// reset() is called whenever the engine resets.
+
+// Discards everything; the emit sites compile away
+struct NullSink {
+    static constexpr bool active() { return false; }
+    void emit(const GameEvent&) {}
+    void reset() {}
 };
 
-class GameEngine {
+// Forwards to an optional callback, the classic setEventCallback behavior
+struct CallbackSink {
+    std::function<void(const GameEvent&)> callback;
+
+    bool active() const { return (bool)callback; }
+    void emit(const GameEvent& event) { callback(event); }
+    void reset() {}
+};
+
+// Keeps every event of the current game, e.g. for replay logs
+struct RecordingSink {
+    std::vector<GameEvent> events;
+
+    static constexpr bool active() { return true; }
+    void emit(const GameEvent& event) { events.push_back(event); }
+    void reset() { events.clear(); }
+};
+
+// std::mt19937 with 32-bit state words instead of uint_fast32_t (64-bit on
+// x86-64): the same sequence, and so the same deals, from half the memory
+typedef std::mersenne_twister_engine<uint32_t, 32, 624, 397, 31, 0x9908b0dfu, 11, 0xffffffffu,
+                                     7, 0x9d2c5680u, 15, 0xefc60000u, 18, 1812433253u> GameRng;
+
+// The state of a game in progress, everything but the RNG, the strategies
+// and the sink. A flat copy of about 1.3 KB, so a replay can keep many.
+struct GameSnapshot {
+    CardList hand1;
+    CardList hand2;
+    CardList drawPile;
+    int books1;
+    int books2;
+    int turn;
+    int winner;
+    GameState gameState;
+    uint16_t deniedRanks[2];
+    uint16_t bookRanks[2];
+    uint64_t hash;
+    BeliefState beliefs;
+};
+
+// The rules and state of a two-AI game. Sink receives the events; the
+// member functions are instantiated in GameEngine.cpp for the three sinks
+// above.
+template <class Sink>
+class BasicGameEngine {
 public:
-    GameEngine();
-    ~GameEngine();
+    BasicGameEngine();
+    ~BasicGameEngine();
     
     // Game control
     void startNewGame();
+    void startNewGame(const CardList& deck); // Deal this 52-card order instead of shuffling
     bool stepGame(); // Execute one game step, returns false if game over
+    // The same step as a coroutine that suspends after each event, once
+    // the event's effect is in the engine state, and yields its type; the
+    // step is over when next() returns false. Plays exactly the moves
+    // stepGame() would. Don't call other game control functions while a
+    // step is suspended, and destroy or reset() the generator before the
+    // engine.
+    Generator<EventType> playTurn();
     void reset();
+    void setSeed(unsigned int seed) { m_rng.seed(seed); } // Makes the following deals reproducible
+    // Who picks player's ranks (0 = AI1); null, the default, for the
+    // built-in lowest-rank AI. Kept across games and resets.
+    void setStrategy(int player, RankChooser chooser) { m_choosers[player] = chooser; }
+    // Copies the game state out and back in; restoring emits no events and
+    // leaves the sink alone. Not while a playTurn() step is suspended.
+    GameSnapshot snapshot() const;
+    void restore(const GameSnapshot& snapshot);
     
     // State queries
     GameState getGameState() const { return m_gameState; }
-    const std::vector<Card>& getHand1() const { return m_hand1; }
-    const std::vector<Card>& getHand2() const { return m_hand2; }
-    const std::vector<Card>& getDrawPile() const { return m_drawPile; }
+    const CardList& getHand1() const { return m_hand1; }
+    const CardList& getHand2() const { return m_hand2; }
+    const CardList& getDrawPile() const { return m_drawPile; }
     int getBooks1() const { return m_books1; }
     int getBooks2() const { return m_books2; }
-    std::string getCurrentTurn() const { return m_turn; }
-    std::string getWinner() const { return m_winner; }
-    const std::vector<GameEvent>& getEventHistory() const { return m_eventHistory; }
-    const GameEvent& getLastEvent() const;
+    const BeliefState& getBeliefs() const { return m_beliefs; }
+    std::string getCurrentTurn() const;
+    std::string getWinner() const;
     
-    // Event callback system
-    void setEventCallback(std::function<void(const GameEvent&)> callback) {
-        m_eventCallback = callback;
-    }
+    // Zobrist hash of packPosition(), kept up to date as cards move
+    uint64_t positionHash() const { return m_hash; }
+    PackedPosition packPosition() const;
+    
+    Sink& sink() { return m_sink; }
+    const Sink& sink() const { return m_sink; }
     
     // Utility functions
     static std::string rankToStr(int rank);
@@ -76,31 +211,69 @@ public:
     static std::string cardToStr(const Card& card);
     
 private:
-    // Game state
-    std::vector<Card> m_hand1;
-    std::vector<Card> m_hand2;
-    std::vector<Card> m_drawPile;
+    // Game state. Cards are stored inline and players are indices
+    // (0 = AI1, 1 = AI2), so a game never touches the heap and starting a
+    // new one only rewrites this object; event text is formatted by
+    // consumers such as GameLog only when displayed.
+    CardList m_hand1;
+    CardList m_hand2;
+    CardList m_drawPile;
     int m_books1;
     int m_books2;
-    std::string m_turn;
-    std::string m_winner;
+    int m_turn;
+    int m_winner; // Player index, 2 for a tie, -1 while playing
     GameState m_gameState;
-    std::map<std::string, std::set<int>> m_deniedRanks;
-    std::vector<GameEvent> m_eventHistory;
-    std::function<void(const GameEvent&)> m_eventCallback;
+    uint16_t m_deniedRanks[2]; // Bit r set: the opponent has no rank r
+    uint16_t m_bookRanks[2];   // Bit r set: the player booked rank r
+    uint64_t m_hash;
+    RankChooser m_choosers[2];
+    BeliefState m_beliefs;
+    Sink m_sink;
+    GameRng m_rng;
     
     // Internal game logic
     void initializeDeck();
+    void beginGame();
     void dealCards();
-    int checkBooks(std::vector<Card>& hand);
-    int countCards(const std::vector<Card>& hand, int rank) const;
-    int chooseRank(const std::vector<Card>& hand, const std::set<int>& denied) const;
-    bool validateRequest(const std::vector<Card>& hand, int rank) const;
-    void processRequest(const std::string& player, const std::string& opponent, int rank,
-                       std::vector<Card>& pHand, std::vector<Card>& oHand, int& pBooks);
+    int checkBooks(CardList& hand);
+    bool formBook(int player, CardList& hand, int rank);
+    int countCards(const CardList& hand, int rank) const;
+    int chooseRank(const CardList& hand, uint16_t denied) const;
+    bool validateRequest(const CardList& hand, int rank) const;
+    int chooseRequest(int player, const CardList& pHand, const CardList& oHand, int pBooks);
+    void processRequest(int player, int rank,
+                       CardList& pHand, CardList& oHand, int& pBooks);
+    void transferCards(int player, int rank, int num, CardList& pHand, CardList& oHand);
+    Card drawCard(int player, CardList& hand);
+    void finishGame();
     bool noValidMoves() const;
+    void setTurn(int player);
+    void denyRank(int player, int rank);
+    void clearDenied(int player);
     bool isGameOver() const;
-    void emitEvent(const GameEvent& event);
+    
+    // Players are indices, -1 for none. Beliefs see every event, whatever
+    // the sink.
+    void emitEvent(EventType type, int player = -1, int opponent = -1, int rank = 0,
+                   int count = 0, Card drawnCard = Card{0, 0}) {
+        m_beliefs.observe(type, player, opponent, rank);
+        if (m_sink.active()) {
+            dispatchEvent(type, player, opponent, rank, count, drawnCard);
+        }
+    }
+    void dispatchEvent(EventType type, int player, int opponent, int rank, int count,
+                       Card drawnCard);
+};
+
+// Engine without events, for headless simulation such as the table grid
+typedef BasicGameEngine<NullSink> QuietGameEngine;
+
+// The engine the UI and tools drive: events go to an optional callback
+class GameEngine : public BasicGameEngine<CallbackSink> {
+public:
+    void setEventCallback(std::function<void(const GameEvent&)> callback) {
+        sink().callback = callback;
+    }
 };
 
 #endif // GAMEENGINE_H
\ No newline at end of file
@@ -0,0 +1,109 @@
+#include "GameLog.h"
+#include <cstdio>
+
+namespace {
+
+const char* const RANK_NAMES[14] = {
+    "?", "Ace", "2", "3", "4", "5", "6", "7", "8", "9", "10", "Jack", "Queen", "King"
+};
+const char* const RANK_PLURALS[14] = {
+    "?", "Aces", "2s", "3s", "4s", "5s", "6s", "7s", "8s", "9s", "10s", "Jacks", "Queens", "Kings"
+};
+const char* const SUIT_NAMES[4] = {"Hearts", "Diamonds", "Clubs", "Spades"};
+const char* const PLAYER_NAMES[3] = {"AI1", "AI2", "Tie"};
+
+uint8_t playerIndex(const std::string& player) {
+    if (player == "AI2") return 1;
+    if (player == "Tie") return 2;
+    return 0;
+}
+
+const char* rankName(uint8_t rank) {
+    return RANK_NAMES[rank < 14 ? rank : 0];
+}
+
+const char* rankPlural(uint8_t rank) {
+    return RANK_PLURALS[rank < 14 ? rank : 0];
+}
+
+} // namespace
+
+GameLog::GameLog() : m_total(0) {
+}
+
+void GameLog::append(const GameEvent& event) {
+    LogRecord& record = m_records[m_total & (CAPACITY - 1)];
+    record.type = (uint8_t)event.type;
+    record.player = playerIndex(event.player);
+    record.rank = 0;
+    record.extra = 0;
+
+    switch (event.type) {
+        case EventType::REQUEST_MADE:
+        case EventType::BOOK_FORMED:
+            record.rank = event.rank;
+            break;
+        case EventType::CARDS_TRANSFERRED:
+            record.rank = event.rank;
+            record.extra = event.count;
+            break;
+        case EventType::CARD_DRAWN:
+            record.rank = event.drawnCard.rank;
+            record.extra = event.drawnCard.suit;
+            break;
+        default:
+            break;
+    }
+    ++m_total;
+}
+
+void GameLog::clear() {
+    m_total = 0;
+}
+
+const LogRecord& GameLog::at(int index) const {
+    uint32_t first = m_total - size();
+    return m_records[(first + index) & (CAPACITY - 1)];
+}
+
+int GameLog::format(const LogRecord& record, char* buffer, int bufferSize) {
+    const char* player = PLAYER_NAMES[record.player < 3 ? record.player : 0];
+    const char* opponent = PLAYER_NAMES[record.player == 1 ? 0 : 1];
+    int n = 0;
+
+    switch ((EventType)record.type) {
+        case EventType::GAME_STARTED:
+            n = snprintf(buffer, bufferSize, "New game started!");
+            break;
+        case EventType::TURN_STARTED:
+            n = snprintf(buffer, bufferSize, "%s's turn", player);
+            break;
+        case EventType::REQUEST_MADE:
+            n = snprintf(buffer, bufferSize, "%s asks %s for %s",
+                         player, opponent, rankPlural(record.rank));
+            break;
+        case EventType::CARDS_TRANSFERRED:
+            n = snprintf(buffer, bufferSize, "%s gives %d %s to %s",
+                         opponent, record.extra, rankPlural(record.rank), player);
+            break;
+        case EventType::GO_FISH:
+            n = snprintf(buffer, bufferSize, "%s says: Go Fish!", opponent);
+            break;
+        case EventType::CARD_DRAWN:
+            n = snprintf(buffer, bufferSize, "%s draws: %s of %s",
+                         player, rankName(record.rank), SUIT_NAMES[record.extra & 3]);
+            break;
+        case EventType::BOOK_FORMED:
+            n = snprintf(buffer, bufferSize, "*** BOOK FORMED: %s completes %s ***",
+                         player, rankPlural(record.rank));
+            break;
+        case EventType::TURN_ENDED:
+            n = snprintf(buffer, bufferSize, "%s's turn ends", player);
+            break;
+        case EventType::GAME_ENDED:
+            n = snprintf(buffer, bufferSize, "Game Over! Winner: %s", player);
+            break;
+    }
+    if (n < 0) n = 0;
+    return n < bufferSize ? n : bufferSize - 1;
+}
@@ -0,0 +1,43 @@
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include <cstdint>
+#include "GameEngine.h"
+
+// Compact record of one game event; text is produced only when displayed
+struct LogRecord {
+    uint8_t type;   // EventType
+    uint8_t player; // 0 = AI1, 1 = AI2, 2 = tie (GAME_ENDED only)
+    uint8_t rank;
+    uint8_t extra;  // Cards transferred, or suit of the drawn card
+};
+
+// Fixed-capacity ring buffer of game events. Appending never allocates;
+// once full the oldest records are overwritten.
+class GameLog {
+public:
+    static const int CAPACITY = 4096; // Power of two
+
+    GameLog();
+
+    void append(const GameEvent& event);
+    void clear();
+    // Back to the first `total` records appended; exact only while nothing
+    // has been overwritten (at most CAPACITY appended)
+    void truncate(uint32_t total) { m_total = total < m_total ? total : m_total; }
+
+    int size() const { return m_total < (uint32_t)CAPACITY ? (int)m_total : CAPACITY; }
+    bool empty() const { return m_total == 0; }
+
+    // 0 = oldest retained record, size() - 1 = newest
+    const LogRecord& at(int index) const;
+
+    // Format a record into `buffer`; returns the text length
+    static int format(const LogRecord& record, char* buffer, int bufferSize);
+
+private:
+    LogRecord m_records[CAPACITY];
+    uint32_t m_total; // Records ever appended since clear()
+};
+
+#endif // GAMELOG_H
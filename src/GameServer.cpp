@@ -0,0 +1,344 @@
+#include "GameServer.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const int LISTEN_BACKLOG = 1024;
+const int MAX_EPOLL_EVENTS = 256;
+const size_t READ_CHUNK = 64 * 1024;
+const int BACKLOG_RETRY_MS = 1; // epoll timeout while commands wait for a full ring
+
+} // namespace
+
+GameServer::GameServer()
+    : m_listenFd(-1), m_epollFd(-1), m_wakeFd(-1), m_running(false),
+      m_nextConnection(FIRST_CONNECTION), m_nextShard(0) {
+}
+
+GameServer::~GameServer() {
+    for (auto& shard : m_shards) {
+        shard->stop();
+    }
+    for (auto& entry : m_connections) {
+        close(entry.second.fd);
+    }
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        unlink(m_socketPath.c_str());
+    }
+    if (m_epollFd >= 0) {
+        close(m_epollFd);
+    }
+    if (m_wakeFd >= 0) {
+        close(m_wakeFd);
+    }
+}
+
+bool GameServer::start(const std::string& socketPath, int shards) {
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path too long: " << socketPath << std::endl;
+        return false;
+    }
+    std::strcpy(address.sun_path, socketPath.c_str());
+
+    m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) {
+        std::cerr << "socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    unlink(socketPath.c_str());
+    if (bind(m_listenFd, (const sockaddr*)&address, sizeof(address)) < 0 ||
+        listen(m_listenFd, LISTEN_BACKLOG) < 0) {
+        std::cerr << "Cannot listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        close(m_listenFd);
+        m_listenFd = -1;
+        return false;
+    }
+    m_socketPath = socketPath;
+
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epollFd < 0 || m_wakeFd < 0) {
+        std::cerr << "epoll/eventfd: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    epoll_event event = epoll_event();
+    event.events = EPOLLIN;
+    event.data.u64 = LISTENER;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_listenFd, &event);
+    event.data.u64 = WAKE;
+    epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event);
+
+    for (int i = 0; i < shards; ++i) {
+        m_shards.emplace_back(new TableShard(i, shards, m_wakeFd));
+        m_shards.back()->start();
+    }
+    m_backlog.resize(shards);
+    m_running.store(true);
+    return true;
+}
+
+void GameServer::stop() {
+    m_running.store(false);
+    uint64_t one = 1;
+    ssize_t written = write(m_wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+void GameServer::run() {
+    epoll_event events[MAX_EPOLL_EVENTS];
+    bool backlogged = false;
+    while (m_running.load()) {
+        int count = epoll_wait(m_epollFd, events, MAX_EPOLL_EVENTS, backlogged ? BACKLOG_RETRY_MS : -1);
+        if (count < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait: " << std::strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            uint32_t id = (uint32_t)events[i].data.u64;
+            if (id == LISTENER) {
+                acceptConnections();
+                continue;
+            }
+            if (id == WAKE) {
+                uint64_t value;
+                ssize_t got = read(m_wakeFd, &value, sizeof(value));
+                (void)got;
+                continue;
+            }
+            auto it = m_connections.find(id);
+            if (it == m_connections.end()) {
+                continue;
+            }
+            if (events[i].events & EPOLLIN) {
+                readFrom(id, it->second);
+            } else if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(id);
+                continue;
+            }
+            it = m_connections.find(id);
+            if (it != m_connections.end() && (events[i].events & EPOLLOUT) && !it->second.dirty) {
+                it->second.dirty = true;
+                m_dirty.push_back(id);
+            }
+        }
+
+        backlogged = flushBacklogs();
+        for (auto& shard : m_shards) {
+            shard->wake();
+        }
+        drainShards();
+        for (uint32_t id : m_dirty) {
+            auto it = m_connections.find(id);
+            if (it != m_connections.end()) {
+                it->second.dirty = false;
+                flush(id, it->second);
+            }
+        }
+        m_dirty.clear();
+    }
+}
+
+void GameServer::acceptConnections() {
+    for (;;) {
+        int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                std::cerr << "accept: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+        uint32_t id = m_nextConnection++;
+        Connection& connection = m_connections[id];
+        connection.fd = fd;
+        connection.written = 0;
+        connection.watchingOut = false;
+        connection.dirty = false;
+        epoll_event event = epoll_event();
+        event.events = EPOLLIN;
+        event.data.u64 = id;
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+}
+
+void GameServer::readFrom(uint32_t id, Connection& connection) {
+    uint8_t buffer[READ_CHUNK];
+    ssize_t got = recv(connection.fd, buffer, sizeof(buffer), 0);
+    if (got <= 0) {
+        if (got == 0 || (errno != EAGAIN && errno != EINTR)) {
+            closeConnection(id);
+        }
+        return;
+    }
+
+    // Decode straight from the read buffer unless a partial frame is waiting
+    bool partial = !connection.in.empty();
+    if (partial) {
+        connection.in.insert(connection.in.end(), buffer, buffer + got);
+    }
+    const uint8_t* data = partial ? connection.in.data() : buffer;
+    size_t available = partial ? connection.in.size() : (size_t)got;
+    size_t offset = 0;
+    for (;;) {
+        int size = Protocol::frameSize(data + offset, available - offset);
+        if (size == 0) {
+            break;
+        }
+        Protocol::Request request;
+        if (size < 0 || !Protocol::decodeRequest(data + offset, size, request)) {
+            closeConnection(id); // Out of step with the client; nothing later can be trusted
+            return;
+        }
+        route(id, request);
+        offset += size;
+    }
+    if (partial) {
+        connection.in.erase(connection.in.begin(), connection.in.begin() + offset);
+    } else {
+        connection.in.assign(buffer + offset, buffer + available);
+    }
+}
+
+void GameServer::route(uint32_t id, const Protocol::Request& request) {
+    int shards = (int)m_shards.size();
+    int shard;
+    if (request.type == Protocol::CREATE_TABLE) {
+        shard = m_nextShard;
+        m_nextShard = (m_nextShard + 1) % shards;
+    } else {
+        shard = (int)(request.table % shards);
+    }
+    ShardCommand command;
+    command.connection = id;
+    command.disconnect = false;
+    command.request = request;
+    post(shard, command);
+}
+
+void GameServer::post(int shard, const ShardCommand& command) {
+    // Queue behind earlier commands so one table's requests stay in order
+    if (!m_backlog[shard].empty() || !m_shards[shard]->post(command)) {
+        m_backlog[shard].push_back(command);
+    }
+}
+
+bool GameServer::flushBacklogs() {
+    bool remaining = false;
+    for (size_t s = 0; s < m_shards.size(); ++s) {
+        std::vector<ShardCommand>& backlog = m_backlog[s];
+        size_t posted = 0;
+        while (posted < backlog.size() && m_shards[s]->post(backlog[posted])) {
+            ++posted;
+        }
+        backlog.erase(backlog.begin(), backlog.begin() + posted);
+        remaining = remaining || !backlog.empty();
+    }
+    return remaining;
+}
+
+void GameServer::drainShards() {
+    ShardOutput output;
+    uint32_t lastId = 0;
+    Connection* last = nullptr;
+    for (auto& shard : m_shards) {
+        shard->clearPending();
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (shard->take(output)) {
+            if (!last || output.connection != lastId) {
+                auto it = m_connections.find(output.connection);
+                last = it != m_connections.end() ? &it->second : nullptr;
+                lastId = output.connection;
+                if (!last) {
+                    continue; // Closed since the request
+                }
+            }
+            last->out.insert(last->out.end(), output.bytes, output.bytes + output.size);
+            if (!last->dirty) {
+                last->dirty = true;
+                m_dirty.push_back(output.connection);
+            }
+        }
+    }
+}
+
+void GameServer::flush(uint32_t id, Connection& connection) {
+    while (connection.written < connection.out.size()) {
+        ssize_t sent = send(connection.fd, connection.out.data() + connection.written,
+                            connection.out.size() - connection.written, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                closeConnection(id);
+                return;
+            }
+            break;
+        }
+        connection.written += sent;
+    }
+
+    bool pending = connection.written < connection.out.size();
+    if (!pending) {
+        connection.out.clear();
+        connection.written = 0;
+    }
+    if (pending != connection.watchingOut) {
+        epoll_event event = epoll_event();
+        event.events = pending ? EPOLLIN | EPOLLOUT : EPOLLIN;
+        event.data.u64 = id;
+        epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.watchingOut = pending;
+    }
+}
+
+void GameServer::closeConnection(uint32_t id) {
+    auto it = m_connections.find(id);
+    if (it == m_connections.end()) {
+        return;
+    }
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+    close(it->second.fd);
+    m_connections.erase(it);
+
+    ShardCommand command = ShardCommand();
+    command.connection = id;
+    command.disconnect = true;
+    for (size_t s = 0; s < m_shards.size(); ++s) {
+        post((int)s, command);
+    }
+}
+
+uint64_t GameServer::tables() const {
+    uint64_t total = 0;
+    for (const auto& shard : m_shards) {
+        total += shard->tables();
+    }
+    return total;
+}
+
+uint64_t GameServer::moves() const {
+    uint64_t total = 0;
+    for (const auto& shard : m_shards) {
+        total += shard->moves();
+    }
+    return total;
+}
+
+uint64_t GameServer::events() const {
+    uint64_t total = 0;
+    for (const auto& shard : m_shards) {
+        total += shard->events();
+    }
+    return total;
+}
@@ -0,0 +1,72 @@
+#ifndef GAMESERVER_H
+#define GAMESERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "TableShard.h"
+
+// Hosts many tables for local bots and viewers (see Protocol.h). One I/O
+// thread runs a level-triggered epoll loop over a Unix-domain listening
+// socket and its connections: it reads and decodes requests, routes each
+// to the shard owning its table (new tables round-robin), and writes the
+// replies and events the shards hand back. Connections belong to the I/O
+// thread only and tables to their shard only, so neither needs locks.
+class GameServer {
+public:
+    GameServer();
+    ~GameServer();
+
+    // Binds socketPath (replacing a stale socket file) and starts the shards
+    bool start(const std::string& socketPath, int shards);
+    // Serves until stop(); call on the thread that called start()
+    void run();
+    // Safe from any thread or a signal handler
+    void stop();
+
+    uint64_t tables() const;
+    uint64_t moves() const;
+    uint64_t events() const;
+    uint64_t connectionsServed() const { return m_nextConnection - FIRST_CONNECTION; }
+
+private:
+    // epoll user data for the two non-connection descriptors
+    static const uint32_t LISTENER = 0;
+    static const uint32_t WAKE = 1;
+    static const uint32_t FIRST_CONNECTION = 2;
+
+    struct Connection {
+        int fd;
+        std::vector<uint8_t> in;
+        std::vector<uint8_t> out;
+        size_t written;   // Bytes of out already sent
+        bool watchingOut; // EPOLLOUT registered
+        bool dirty;       // Has output to flush this iteration
+    };
+
+    std::string m_socketPath;
+    int m_listenFd;
+    int m_epollFd;
+    int m_wakeFd; // Written by shards with output and by stop()
+    std::atomic<bool> m_running;
+    std::vector<std::unique_ptr<TableShard>> m_shards;
+    std::vector<std::vector<ShardCommand>> m_backlog; // Per shard, when its ring is full
+    std::unordered_map<uint32_t, Connection> m_connections;
+    std::vector<uint32_t> m_dirty;
+    uint32_t m_nextConnection;
+    int m_nextShard;
+
+    void acceptConnections();
+    void readFrom(uint32_t id, Connection& connection);
+    void route(uint32_t id, const Protocol::Request& request);
+    void post(int shard, const ShardCommand& command);
+    bool flushBacklogs();
+    void drainShards();
+    void flush(uint32_t id, Connection& connection);
+    void closeConnection(uint32_t id);
+};
+
+#endif // GAMESERVER_H
@@ -0,0 +1,63 @@
+#include "Generator.h"
+#include <new>
+
+namespace {
+
+const std::size_t FRAME_GRAIN = 64;
+const int FRAME_CLASSES = 32; // Frames up to 2 KB are pooled, larger ones go to the heap
+
+struct FreeFrame {
+    FreeFrame* next;
+};
+
+// Frames stay on their list until the thread exits
+struct FrameLists {
+    FreeFrame* heads[FRAME_CLASSES] = {};
+
+    ~FrameLists() {
+        for (FreeFrame*& head : heads) {
+            while (head) {
+                FreeFrame* frame = head;
+                head = frame->next;
+                ::operator delete(frame);
+            }
+        }
+    }
+};
+
+thread_local FrameLists t_frames;
+
+int frameClass(std::size_t size) {
+    return (int)((size + FRAME_GRAIN - 1) / FRAME_GRAIN) - 1;
+}
+
+} // namespace
+
+namespace FramePool {
+
+void* allocate(std::size_t size) {
+    int index = frameClass(size);
+    if (index >= FRAME_CLASSES) {
+        return ::operator new(size);
+    }
+    FreeFrame*& head = t_frames.heads[index];
+    if (head) {
+        FreeFrame* frame = head;
+        head = frame->next;
+        return frame;
+    }
+    return ::operator new((index + 1) * FRAME_GRAIN);
+}
+
+void release(void* frame, std::size_t size) {
+    int index = frameClass(size);
+    if (index >= FRAME_CLASSES) {
+        ::operator delete(frame);
+        return;
+    }
+    FreeFrame* free = static_cast<FreeFrame*>(frame);
+    free->next = t_frames.heads[index];
+    t_frames.heads[index] = free;
+}
+
+} // namespace FramePool
@@ -0,0 +1,84 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <utility>
+
+// Coroutine frames come from a per-thread free list sorted into 64-byte
+// size classes, so a coroutine that is started again and again (one per
+// turn) stops allocating once the first frame has been released.
+namespace FramePool {
+
+void* allocate(std::size_t size);
+void release(void* frame, std::size_t size);
+
+} // namespace FramePool
+
+// Minimal lazy generator: the body runs only inside next(), up to its next
+// co_yield. Owns the coroutine and destroys it, finished or not, with the
+// generator; values must be cheap to copy.
+template <class T>
+class Generator {
+public:
+    struct promise_type {
+        T current{};
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(T value) noexcept {
+            current = value;
+            return {};
+        }
+        void return_void() noexcept {}
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(std::size_t size) { return FramePool::allocate(size); }
+        static void operator delete(void* frame, std::size_t size) {
+            FramePool::release(frame, size);
+        }
+    };
+
+    Generator() : m_handle(nullptr) {}
+    Generator(Generator&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    ~Generator() { reset(); }
+
+    // Runs to the next co_yield; false once the body has returned
+    bool next() {
+        if (done()) {
+            return false;
+        }
+        m_handle.resume();
+        return !m_handle.done();
+    }
+    const T& value() const { return m_handle.promise().current; } // After next() returned true
+    bool done() const { return !m_handle || m_handle.done(); }
+
+    // Abandons the coroutine wherever it is suspended
+    void reset() {
+        if (m_handle) {
+            m_handle.destroy();
+            m_handle = nullptr;
+        }
+    }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+#endif // GENERATOR_H
@@ -0,0 +1,248 @@
+#include "ImageRenderTarget.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// 5x7 font for ASCII 0x20-0x7E; one byte per column, bit 0 = top row
+const unsigned char FONT_5X7[95][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, // space !
+    {0x00, 0x07, 0x00, 0x07, 0x00}, {0x14, 0x7F, 0x14, 0x7F, 0x14}, // " #
+    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62}, // $ %
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, // & '
+    {0x00, 0x1C, 0x22, 0x41, 0x00}, {0x00, 0x41, 0x22, 0x1C, 0x00}, // ( )
+    {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08}, // * +
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, // , -
+    {0x00, 0x60, 0x60, 0x00, 0x00}, {0x20, 0x10, 0x08, 0x04, 0x02}, // . /
+    {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00}, // 0 1
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, // 2 3
+    {0x18, 0x14, 0x12, 0x7F, 0x10}, {0x27, 0x45, 0x45, 0x45, 0x39}, // 4 5
+    {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03}, // 6 7
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, // 8 9
+    {0x00, 0x36, 0x36, 0x00, 0x00}, {0x00, 0x56, 0x36, 0x00, 0x00}, // : ;
+    {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14}, // < =
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, // > ?
+    {0x32, 0x49, 0x79, 0x41, 0x3E}, {0x7E, 0x11, 0x11, 0x11, 0x7E}, // @ A
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22}, // B C
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, // D E
+    {0x7F, 0x09, 0x09, 0x09, 0x01}, {0x3E, 0x41, 0x49, 0x49, 0x7A}, // F G
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00}, // H I
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, // J K
+    {0x7F, 0x40, 0x40, 0x40, 0x40}, {0x7F, 0x02, 0x0C, 0x02, 0x7F}, // L M
+    {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E}, // N O
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, // P Q
+    {0x7F, 0x09, 0x19, 0x29, 0x46}, {0x46, 0x49, 0x49, 0x49, 0x31}, // R S
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F}, // T U
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, // V W
+    {0x63, 0x14, 0x08, 0x14, 0x63}, {0x07, 0x08, 0x70, 0x08, 0x07}, // X Y
+    {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00}, // Z [
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, // \ ]
+    {0x04, 0x02, 0x01, 0x02, 0x04}, {0x40, 0x40, 0x40, 0x40, 0x40}, // ^ _
+    {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78}, // ` a
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, // b c
+    {0x38, 0x44, 0x44, 0x48, 0x7F}, {0x38, 0x54, 0x54, 0x54, 0x18}, // d e
+    {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E}, // f g
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, // h i
+    {0x20, 0x40, 0x44, 0x3D, 0x00}, {0x7F, 0x10, 0x28, 0x44, 0x00}, // j k
+    {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78}, // l m
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, // n o
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, {0x08, 0x14, 0x14, 0x18, 0x7C}, // p q
+    {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20}, // r s
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, // t u
+    {0x1C, 0x20, 0x40, 0x20, 0x1C}, {0x3C, 0x40, 0x30, 0x40, 0x3C}, // v w
+    {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C}, // x y
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, // z {
+    {0x00, 0x00, 0x7F, 0x00, 0x00}, {0x00, 0x41, 0x36, 0x08, 0x00}, // | }
+    {0x08, 0x04, 0x08, 0x10, 0x08}                                   // ~
+};
+
+const int GLYPH_ADVANCE = 6;
+
+uint32_t crc32(const unsigned char* data, size_t length, uint32_t crc) {
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        initialized = true;
+    }
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+void putBE32(std::vector<unsigned char>& out, uint32_t v) {
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+void writeChunk(FILE* f, const char* type, const std::vector<unsigned char>& data) {
+    std::vector<unsigned char> chunk;
+    putBE32(chunk, data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(&chunk[4], chunk.size() - 4, 0));
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+} // namespace
+
+ImageRenderTarget::ImageRenderTarget(int width, int height)
+    : m_width(0), m_height(0), m_color(0), m_commands(0) {
+    resize(width, height);
+}
+
+unsigned long ImageRenderTarget::allocateColor(int r, int g, int b) {
+    return ((unsigned long)(r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF);
+}
+
+void ImageRenderTarget::fillRect(int x, int y, int width, int height) {
+    fillClipped(x, y, x + width, y + height);
+    ++m_commands;
+}
+
+void ImageRenderTarget::drawRect(int x, int y, int width, int height) {
+    // Same footprint as XDrawRectangle: the outline covers width+1 x height+1
+    fillClipped(x, y, x + width + 1, y + 1);
+    fillClipped(x, y + height, x + width + 1, y + height + 1);
+    fillClipped(x, y, x + 1, y + height + 1);
+    fillClipped(x + width, y, x + width + 1, y + height + 1);
+    ++m_commands;
+}
+
+void ImageRenderTarget::drawText(int x, int y, const char* text, int length) {
+    for (int i = 0; i < length; ++i) {
+        unsigned char ch = text[i];
+        if ((ch & 0xC0) == 0x80) {
+            continue; // UTF-8 continuation byte
+        }
+        drawGlyph(x, y - 7, ch);
+        x += GLYPH_ADVANCE;
+    }
+    ++m_commands;
+}
+
+void ImageRenderTarget::resize(int width, int height) {
+    if (width == m_width && height == m_height) {
+        return;
+    }
+    m_width = std::max(1, width);
+    m_height = std::max(1, height);
+    m_pixels.assign((size_t)m_width * m_height, 0);
+}
+
+void ImageRenderTarget::fillClipped(int x0, int y0, int x1, int y1) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, m_width);
+    y1 = std::min(y1, m_height);
+    for (int y = y0; y < y1; ++y) {
+        uint32_t* row = &m_pixels[(size_t)y * m_width];
+        std::fill(row + x0, row + std::max(x0, x1), m_color);
+    }
+}
+
+void ImageRenderTarget::drawGlyph(int x, int y, unsigned char ch) {
+    if (ch < 0x20 || ch > 0x7E) {
+        // Non-ASCII (e.g. suit symbols): draw a solid cell
+        fillClipped(x, y, x + 5, y + 7);
+        return;
+    }
+    const unsigned char* glyph = FONT_5X7[ch - 0x20];
+    for (int col = 0; col < 5; ++col) {
+        for (int row = 0; row < 7; ++row) {
+            if (glyph[col] >> row & 1) {
+                fillClipped(x + col, y + row, x + col + 1, y + row + 1);
+            }
+        }
+    }
+}
+
+bool ImageRenderTarget::savePPM(const std::string& path) const {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", m_width, m_height);
+    std::vector<unsigned char> row(m_width * 3);
+    for (int y = 0; y < m_height; ++y) {
+        for (int x = 0; x < m_width; ++x) {
+            uint32_t p = m_pixels[(size_t)y * m_width + x];
+            row[x * 3] = p >> 16;
+            row[x * 3 + 1] = p >> 8;
+            row[x * 3 + 2] = p;
+        }
+        fwrite(row.data(), 1, row.size(), f);
+    }
+    return fclose(f) == 0;
+}
+
+bool ImageRenderTarget::savePNG(const std::string& path) const {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+
+    std::vector<unsigned char> header;
+    putBE32(header, m_width);
+    putBE32(header, m_height);
+    header.push_back(8); // Bit depth
+    header.push_back(2); // Color type: RGB
+    header.push_back(0); // Deflate
+    header.push_back(0); // Adaptive filtering
+    header.push_back(0); // No interlace
+    writeChunk(f, "IHDR", header);
+
+    // Raw scanlines, each prefixed with filter type 0
+    std::vector<unsigned char> raw;
+    raw.reserve((size_t)m_height * (m_width * 3 + 1));
+    for (int y = 0; y < m_height; ++y) {
+        raw.push_back(0);
+        for (int x = 0; x < m_width; ++x) {
+            uint32_t p = m_pixels[(size_t)y * m_width + x];
+            raw.push_back(p >> 16);
+            raw.push_back(p >> 8);
+            raw.push_back(p);
+        }
+    }
+
+    // zlib stream made of stored (uncompressed) deflate blocks, so no
+    // compression library is needed
+    std::vector<unsigned char> zdata;
+    zdata.push_back(0x78);
+    zdata.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    size_t pos = 0;
+    do {
+        size_t len = std::min<size_t>(65535, raw.size() - pos);
+        bool last = pos + len == raw.size();
+        zdata.push_back(last ? 1 : 0);
+        zdata.push_back(len & 0xFF);
+        zdata.push_back(len >> 8);
+        zdata.push_back(~len & 0xFF);
+        zdata.push_back((~len >> 8) & 0xFF);
+        for (size_t i = 0; i < len; ++i) {
+            unsigned char c = raw[pos + i];
+            zdata.push_back(c);
+            a = (a + c) % 65521;
+            b = (b + a) % 65521;
+        }
+        pos += len;
+    } while (pos < raw.size());
+    putBE32(zdata, (b << 16) | a);
+    writeChunk(f, "IDAT", zdata);
+
+    writeChunk(f, "IEND", std::vector<unsigned char>());
+    return fclose(f) == 0;
+}
@@ -0,0 +1,49 @@
+#ifndef IMAGERENDERTARGET_H
+#define IMAGERENDERTARGET_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "RenderTarget.h"
+
+// Software render target drawing into an in-memory 0xRRGGBB image. Needs no
+// X server, so frames can be rendered, timed and dumped on build machines.
+// Text uses a built-in 5x7 bitmap font laid out on a 6-pixel advance.
+class ImageRenderTarget : public RenderTarget {
+public:
+    ImageRenderTarget(int width, int height);
+
+    unsigned long allocateColor(int r, int g, int b) override;
+    unsigned long blackPixel() const override { return 0x000000; }
+    unsigned long whitePixel() const override { return 0xFFFFFF; }
+
+    void setColor(unsigned long pixel) override { m_color = (uint32_t)pixel; ++m_commands; }
+    void fillRect(int x, int y, int width, int height) override;
+    void drawRect(int x, int y, int width, int height) override;
+    void drawText(int x, int y, const char* text, int length) override;
+
+    void resize(int width, int height) override;
+    void present() override {}
+
+    int commandCount() const override { return m_commands; }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    const std::vector<uint32_t>& pixels() const { return m_pixels; }
+
+    // Image dumps; return false on I/O errors
+    bool savePPM(const std::string& path) const;
+    bool savePNG(const std::string& path) const;
+
+private:
+    int m_width;
+    int m_height;
+    uint32_t m_color;
+    int m_commands;
+    std::vector<uint32_t> m_pixels;
+
+    void fillClipped(int x0, int y0, int x1, int y1); // Half-open span
+    void drawGlyph(int x, int y, unsigned char ch);
+};
+
+#endif // IMAGERENDERTARGET_H
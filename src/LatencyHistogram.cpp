@@ -0,0 +1,69 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cstdio>
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketIndex(uint64_t nanoseconds) {
+    const uint64_t sub = 1 << SUB_BITS;
+    if (nanoseconds < sub) {
+        return (int)nanoseconds; // Exact below the first split power of two
+    }
+    int exponent = 63 - __builtin_clzll(nanoseconds);
+    int mantissa = (int)(nanoseconds >> (exponent - SUB_BITS)) & (sub - 1);
+    return ((exponent - SUB_BITS + 1) << SUB_BITS) + mantissa;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    const int sub = 1 << SUB_BITS;
+    if (index < sub) {
+        return index;
+    }
+    int shift = (index >> SUB_BITS) - 1;
+    uint64_t lower = (uint64_t)(sub + (index & (sub - 1))) << shift;
+    return lower + ((uint64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    m_buckets[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    uint64_t previous = m_max.load(std::memory_order_relaxed);
+    while (nanoseconds > previous &&
+           !m_max.compare_exchange_weak(previous, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::percentileNs(double fraction) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)(fraction * total + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKETS; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucketUpperBound(i), maxNs());
+        }
+    }
+    return maxNs();
+}
+
+int LatencyHistogram::format(char* buffer, int size) const {
+    if (count() == 0) {
+        return snprintf(buffer, size, "no samples");
+    }
+    return snprintf(buffer, size, "p50 %.2f ms  p99 %.2f ms  max %.2f ms  (n=%llu)",
+                    percentileNs(0.50) / 1e6, percentileNs(0.99) / 1e6, maxNs() / 1e6,
+                    (unsigned long long)count());
+}
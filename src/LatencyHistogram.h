@@ -0,0 +1,45 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Nanoseconds on the steady clock; the time base for event timestamps
+inline uint64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Log-linear latency histogram: each power of two is split into 8 buckets,
+// so percentiles are within 12.5% of the true value. record() is lock-free
+// and may run on any thread while another reads the summary.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t nanoseconds);
+    void reset();
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t maxNs() const { return m_max.load(std::memory_order_relaxed); }
+
+    // Upper bound of the bucket holding the given fraction (0..1) of samples
+    uint64_t percentileNs(double fraction) const;
+
+    // "p50 1.20 ms  p99 3.40 ms  max 5.60 ms  (n=123)"
+    int format(char* buffer, int size) const;
+
+private:
+    static const int SUB_BITS = 3;
+    static const int BUCKETS = 64 << SUB_BITS;
+
+    std::atomic<uint32_t> m_buckets[BUCKETS];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_max;
+
+    static int bucketIndex(uint64_t nanoseconds);
+    static uint64_t bucketUpperBound(int index);
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,150 @@
+#include "MixKernels.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MIX_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void mixScalar(float* accumulator, const int16_t* samples, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        accumulator[i] += samples[i] * gain;
+    }
+}
+
+void scaleScalar(const float* accumulator, int16_t* output, size_t count, float volume) {
+    for (size_t i = 0; i < count; ++i) {
+        float value = accumulator[i] * volume;
+        if (value > 32767.0f) value = 32767.0f;
+        if (value < -32768.0f) value = -32768.0f;
+        output[i] = (int16_t)lrintf(value);
+    }
+}
+
+#ifdef MIX_X86
+
+__attribute__((target("sse2")))
+void mixSse2(float* accumulator, const int16_t* samples, size_t count, float gain) {
+    const __m128 scale = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm_loadu_si128((const __m128i*)(samples + i));
+        // Sign-extend by placing each sample in the high half and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        __m128 a = _mm_add_ps(_mm_loadu_ps(accumulator + i), _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(accumulator + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        _mm_storeu_ps(accumulator + i, a);
+        _mm_storeu_ps(accumulator + i + 4, b);
+    }
+    mixScalar(accumulator + i, samples + i, count - i, gain);
+}
+
+__attribute__((target("sse2")))
+void scaleSse2(const float* accumulator, int16_t* output, size_t count, float volume) {
+    const __m128 scale = _mm_set1_ps(volume);
+    const __m128 upper = _mm_set1_ps(32767.0f);
+    const __m128 lower = _mm_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // Clamp before converting: out-of-range floats convert to INT_MIN
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(accumulator + i), scale), lower), upper);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(accumulator + i + 4), scale), lower), upper);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i*)(output + i), packed);
+    }
+    scaleScalar(accumulator + i, output + i, count - i, volume);
+}
+
+__attribute__((target("avx2")))
+void mixAvx2(float* accumulator, const int16_t* samples, size_t count, float gain) {
+    const __m256 scale = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(samples + i)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(samples + i + 8)));
+        __m256 a = _mm256_add_ps(_mm256_loadu_ps(accumulator + i), _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+        __m256 b = _mm256_add_ps(_mm256_loadu_ps(accumulator + i + 8), _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+        _mm256_storeu_ps(accumulator + i, a);
+        _mm256_storeu_ps(accumulator + i + 8, b);
+    }
+    mixScalar(accumulator + i, samples + i, count - i, gain);
+}
+
+__attribute__((target("avx2")))
+void scaleAvx2(const float* accumulator, int16_t* output, size_t count, float volume) {
+    const __m256 scale = _mm256_set1_ps(volume);
+    const __m256 upper = _mm256_set1_ps(32767.0f);
+    const __m256 lower = _mm256_set1_ps(-32768.0f);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(accumulator + i), scale), lower), upper);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(accumulator + i + 8), scale), lower), upper);
+        // The pack works per 128-bit lane; restore sample order afterwards
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256((__m256i*)(output + i), packed);
+    }
+    scaleScalar(accumulator + i, output + i, count - i, volume);
+}
+
+#endif // MIX_X86
+
+} // namespace
+
+bool isMixKernelSupported(MixKernel kernel) {
+    switch (kernel) {
+    case MixKernel::SCALAR:
+        return true;
+#ifdef MIX_X86
+    case MixKernel::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case MixKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+MixKernel detectMixKernel() {
+    if (isMixKernelSupported(MixKernel::AVX2)) {
+        return MixKernel::AVX2;
+    }
+    if (isMixKernelSupported(MixKernel::SSE2)) {
+        return MixKernel::SSE2;
+    }
+    return MixKernel::SCALAR;
+}
+
+const char* mixKernelName(MixKernel kernel) {
+    switch (kernel) {
+    case MixKernel::SSE2: return "sse2";
+    case MixKernel::AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+void mixSamples(MixKernel kernel, float* accumulator, const int16_t* samples,
+                size_t count, float gain) {
+    switch (kernel) {
+#ifdef MIX_X86
+    case MixKernel::SSE2: mixSse2(accumulator, samples, count, gain); break;
+    case MixKernel::AVX2: mixAvx2(accumulator, samples, count, gain); break;
+#endif
+    default: mixScalar(accumulator, samples, count, gain); break;
+    }
+}
+
+void scaleToInt16(MixKernel kernel, const float* accumulator, int16_t* output,
+                  size_t count, float volume) {
+    switch (kernel) {
+#ifdef MIX_X86
+    case MixKernel::SSE2: scaleSse2(accumulator, output, count, volume); break;
+    case MixKernel::AVX2: scaleAvx2(accumulator, output, count, volume); break;
+#endif
+    default: scaleScalar(accumulator, output, count, volume); break;
+    }
+}
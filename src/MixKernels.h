@@ -0,0 +1,28 @@
+#ifndef MIXKERNELS_H
+#define MIXKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Inner loops of the software mixer. The SIMD variants are compiled with
+// per-function target attributes so one binary runs everywhere; the best
+// one for the running CPU is picked at startup.
+enum class MixKernel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+MixKernel detectMixKernel();
+bool isMixKernelSupported(MixKernel kernel);
+const char* mixKernelName(MixKernel kernel);
+
+// accumulator[i] += samples[i] * gain
+void mixSamples(MixKernel kernel, float* accumulator, const int16_t* samples,
+                size_t count, float gain);
+
+// output[i] = accumulator[i] * volume, rounded and clamped to 16 bits
+void scaleToInt16(MixKernel kernel, const float* accumulator, int16_t* output,
+                  size_t count, float volume);
+
+#endif // MIXKERNELS_H
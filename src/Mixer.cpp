@@ -0,0 +1,87 @@
+#include "Mixer.h"
+#include <algorithm>
+
+Mixer::Mixer(int channels)
+    : m_channels(channels), m_maxVoices(MIXER_DEFAULT_VOICES), m_cooldownFrames(0),
+      m_volume(1.0f), m_kernel(detectMixKernel()), m_stolen(0), m_merged(0) {
+    m_voices.reserve(MIXER_VOICE_LIMIT);
+}
+
+void Mixer::setMaxVoices(int voices) {
+    m_maxVoices = std::max(1, std::min(MIXER_VOICE_LIMIT, voices));
+    if ((int)m_voices.size() > m_maxVoices) {
+        m_voices.resize(m_maxVoices);
+    }
+}
+
+bool Mixer::start(const int16_t* samples, size_t count, float gain, int sound) {
+    if (!samples || count == 0) {
+        return false;
+    }
+
+    if (sound >= 0) {
+        size_t cooldown = (size_t)m_cooldownFrames * m_channels;
+        for (auto& voice : m_voices) {
+            if (voice.sound == sound && voice.position < cooldown) {
+                // Same sound just started: keep the louder of the two
+                voice.gain = std::max(voice.gain, gain);
+                ++m_merged;
+                return false;
+            }
+        }
+    }
+
+    Voice voice = {samples, count, 0, gain, sound};
+    if ((int)m_voices.size() < m_maxVoices) {
+        m_voices.push_back(voice);
+        return true;
+    }
+
+    // Steal the voice with the least left to play; it is the least missed
+    size_t victim = 0;
+    for (size_t i = 1; i < m_voices.size(); ++i) {
+        if (m_voices[i].length - m_voices[i].position <
+            m_voices[victim].length - m_voices[victim].position) {
+            victim = i;
+        }
+    }
+    m_voices[victim] = voice;
+    ++m_stolen;
+    return true;
+}
+
+void Mixer::stop(int sound) {
+    for (size_t i = 0; i < m_voices.size();) {
+        if (m_voices[i].sound == sound) {
+            m_voices[i] = m_voices.back();
+            m_voices.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void Mixer::mix(int16_t* output, int frames) {
+    size_t samples = (size_t)frames * m_channels;
+    if (m_accumulator.size() < samples) {
+        m_accumulator.resize(samples);
+    }
+    std::fill(m_accumulator.begin(), m_accumulator.begin() + samples, 0.0f);
+
+    for (size_t i = 0; i < m_voices.size();) {
+        Voice& voice = m_voices[i];
+        size_t count = std::min(samples, voice.length - voice.position);
+        mixSamples(m_kernel, m_accumulator.data(), voice.samples + voice.position, count, voice.gain);
+        voice.position += count;
+
+        // Drop finished voices by swapping in the last one
+        if (voice.position >= voice.length) {
+            voice = m_voices.back();
+            m_voices.pop_back();
+        } else {
+            ++i;
+        }
+    }
+
+    scaleToInt16(m_kernel, m_accumulator.data(), output, samples, m_volume);
+}
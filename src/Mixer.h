@@ -0,0 +1,67 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <cstdint>
+#include <vector>
+#include "MixKernels.h"
+
+// Hard upper bound on simultaneous voices; storage for it is reserved up
+// front so starting a voice never allocates
+const int MIXER_VOICE_LIMIT = 64;
+const int MIXER_DEFAULT_VOICES = 16;
+
+// Voice bookkeeping and mixing for one output stream. Not thread safe;
+// AudioEngine drives it from its mixer thread.
+class Mixer {
+public:
+    explicit Mixer(int channels = 2);
+
+    void setChannels(int channels) { m_channels = channels; }
+
+    // Voices beyond this steal the one closest to finishing (1..MIXER_VOICE_LIMIT)
+    void setMaxVoices(int voices);
+    int getMaxVoices() const { return m_maxVoices; }
+
+    // A sound restarted within this many frames of its last start is merged
+    // into the playing voice instead of stacking another copy
+    void setCooldownFrames(int frames) { m_cooldownFrames = frames < 0 ? 0 : frames; }
+
+    void setMasterVolume(float volume) { m_volume = volume; }
+    void setKernel(MixKernel kernel) { m_kernel = kernel; }
+    MixKernel getKernel() const { return m_kernel; }
+
+    // Start `count` interleaved samples; `sound` identifies the source for
+    // cooldown merging (negative disables it). Returns false if merged.
+    bool start(const int16_t* samples, size_t count, float gain, int sound);
+    void stop(int sound);
+    void stopAll() { m_voices.clear(); }
+
+    // Mix the next `frames` frames of all voices into `output`
+    void mix(int16_t* output, int frames);
+
+    int activeVoices() const { return (int)m_voices.size(); }
+    uint64_t voicesStolen() const { return m_stolen; }
+    uint64_t voicesMerged() const { return m_merged; }
+
+private:
+    struct Voice {
+        const int16_t* samples;
+        size_t length;
+        size_t position; // Next sample index
+        float gain;
+        int sound;
+    };
+
+    int m_channels;
+    int m_maxVoices;
+    int m_cooldownFrames;
+    float m_volume;
+    MixKernel m_kernel;
+
+    std::vector<Voice> m_voices;
+    std::vector<float> m_accumulator;
+    uint64_t m_stolen;
+    uint64_t m_merged;
+};
+
+#endif // MIXER_H
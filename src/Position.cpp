@@ -0,0 +1,152 @@
+#include "Position.h"
+
+namespace {
+
+const int RANKS = 13;
+const int STATE_BITS = 5;
+const int STATES = 17;      // 15 ways to split 4 cards between two hands and the pile, 2 book owners
+const int BOOKED_BY_AI1 = 15;
+const int BOOKED_BY_AI2 = 16;
+const int DENIED_SHIFT = 5; // In hi, after rank 13
+
+// State tables, filled once before main
+struct StateTables {
+    int index[5][5];   // [hand1][hand2] -> state
+    int hand1[STATES];
+    int hand2[STATES];
+
+    StateTables() {
+        int n = 0;
+        for (int a = 0; a <= 4; ++a) {
+            for (int b = 0; b <= 4; ++b) {
+                index[a][b] = -1;
+                if (a + b <= 4) {
+                    hand1[n] = a;
+                    hand2[n] = b;
+                    index[a][b] = n++;
+                }
+            }
+        }
+        hand1[BOOKED_BY_AI1] = hand2[BOOKED_BY_AI1] = 0;
+        hand1[BOOKED_BY_AI2] = hand2[BOOKED_BY_AI2] = 0;
+    }
+};
+
+const StateTables g_states;
+
+struct ZobristKeys {
+    uint64_t hand[2][14][5];
+    uint64_t book[2][14];
+    uint64_t denied[2][14];
+    uint64_t turn;
+
+    // Fixed splitmix64 sequence, so hashes are stable between runs
+    ZobristKeys() {
+        uint64_t state = 0x2545f4914f6cdd1dull;
+        for (int p = 0; p < 2; ++p) {
+            for (int r = 0; r < 14; ++r) {
+                hand[p][r][0] = 0;
+                for (int c = 1; c <= 4; ++c) {
+                    hand[p][r][c] = next(state);
+                }
+                book[p][r] = next(state);
+                denied[p][r] = next(state);
+            }
+        }
+        turn = next(state);
+    }
+
+    static uint64_t next(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
+
+const ZobristKeys g_keys;
+
+int rankState(const PackedPosition& position, int rank) {
+    int bit = (rank - 1) * STATE_BITS;
+    uint64_t word = rank <= 12 ? position.lo >> bit : position.hi;
+    return (int)(word & ((1u << STATE_BITS) - 1));
+}
+
+} // namespace
+
+PackedPosition PackedPosition::pack(const int counts[2][14], const uint16_t books[2],
+                                    const uint16_t denied[2], int turn) {
+    PackedPosition position = {0, 0};
+    for (int r = 1; r <= RANKS; ++r) {
+        uint64_t state;
+        if (books[0] & (1u << r)) {
+            state = BOOKED_BY_AI1;
+        } else if (books[1] & (1u << r)) {
+            state = BOOKED_BY_AI2;
+        } else {
+            state = g_states.index[counts[0][r]][counts[1][r]];
+        }
+        if (r <= 12) {
+            position.lo |= state << ((r - 1) * STATE_BITS);
+        } else {
+            position.hi |= state;
+        }
+    }
+    position.hi |= (uint64_t)((denied[0] >> 1) & 0x1fff) << DENIED_SHIFT;
+    position.hi |= (uint64_t)((denied[1] >> 1) & 0x1fff) << (DENIED_SHIFT + RANKS);
+    position.hi |= (uint64_t)(turn & 1) << 31;
+    return position;
+}
+
+int PackedPosition::handCount(int player, int rank) const {
+    int state = rankState(*this, rank);
+    return player == 0 ? g_states.hand1[state] : g_states.hand2[state];
+}
+
+int PackedPosition::bookOwner(int rank) const {
+    int state = rankState(*this, rank);
+    return state == BOOKED_BY_AI1 ? 0 : state == BOOKED_BY_AI2 ? 1 : -1;
+}
+
+uint16_t PackedPosition::denied(int player) const {
+    int shift = DENIED_SHIFT + player * RANKS;
+    return (uint16_t)(((hi >> shift) & 0x1fff) << 1);
+}
+
+namespace Zobrist {
+
+uint64_t hand(int player, int rank, int count) {
+    return g_keys.hand[player][rank][count];
+}
+
+uint64_t book(int player, int rank) {
+    return g_keys.book[player][rank];
+}
+
+uint64_t denied(int player, int rank) {
+    return g_keys.denied[player][rank];
+}
+
+uint64_t turn() {
+    return g_keys.turn;
+}
+
+uint64_t hash(const PackedPosition& position) {
+    uint64_t h = position.turn() ? g_keys.turn : 0;
+    for (int r = 1; r <= RANKS; ++r) {
+        int owner = position.bookOwner(r);
+        if (owner >= 0) {
+            h ^= g_keys.book[owner][r];
+            continue;
+        }
+        for (int p = 0; p < 2; ++p) {
+            h ^= g_keys.hand[p][r][position.handCount(p, r)];
+            if (position.denied(p) & (1u << r)) {
+                h ^= g_keys.denied[p][r];
+            }
+        }
+    }
+    return h;
+}
+
+} // namespace Zobrist
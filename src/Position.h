@@ -0,0 +1,52 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <cstdint>
+
+// A game position packed into 128 bits for search and transposition
+// tables. Suits never influence play (see DealKey), so ownership is kept
+// per rank: each rank is in one of 17 states, how many of its cards each
+// hand holds (the rest are in the pile) or which player booked it. The
+// pile counts as an unordered set, which is how a player sees it.
+//
+//   lo bits 0-59   ranks 1-12, 5-bit state each
+//   hi bits 0-4    rank 13
+//   hi bits 5-17   ranks AI1 has been denied (bit 0 = ace)
+//   hi bits 18-30  ranks AI2 has been denied
+//   hi bit 31      AI2 to move
+struct PackedPosition {
+    uint64_t lo;
+    uint64_t hi; // Upper 32 bits always zero
+
+    // counts[p][r]: cards of rank r (1-13) in player p's hand; books[p]:
+    // bit r set for ranks p has booked; denied[p]: bit r as in the engine
+    static PackedPosition pack(const int counts[2][14], const uint16_t books[2],
+                               const uint16_t denied[2], int turn);
+
+    int handCount(int player, int rank) const;
+    int bookOwner(int rank) const; // -1 while the rank is in play
+    uint16_t denied(int player) const; // Engine layout, bit r for rank r
+    int turn() const { return (int)(hi >> 31) & 1; }
+
+    bool operator==(const PackedPosition& other) const {
+        return lo == other.lo && hi == other.hi;
+    }
+};
+
+// Random keys for incrementally maintained 64-bit position hashes: the XOR
+// of hand(p, r, count) over players and ranks, book(p, r) for every book,
+// denied(p, r) for every denied rank and turn() while AI2 is to move.
+// hand(p, r, 0) is zero so empty ranks cost nothing.
+namespace Zobrist {
+
+uint64_t hand(int player, int rank, int count);
+uint64_t book(int player, int rank);
+uint64_t denied(int player, int rank);
+uint64_t turn();
+
+// The same hash computed from scratch
+uint64_t hash(const PackedPosition& position);
+
+} // namespace Zobrist
+
+#endif // POSITION_H
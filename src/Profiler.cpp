@@ -0,0 +1,145 @@
+#include "Profiler.h"
+
+#ifdef GOFISH_PROFILE
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const int PHASES = (int)ProfilePhase::COUNT;
+const int COUNTERS = (int)ProfileCounter::COUNT;
+
+const char* PHASE_NAMES[PHASES] = {
+    "engine.step", "engine.end_check", "engine.choose", "engine.request",
+    "engine.transfer", "engine.draw", "engine.books", "engine.dispatch",
+    "ui.events", "ui.update", "ui.render", "ui.render.clear",
+    "ui.render.screen", "ui.render.overlay", "ui.present",
+    "audio.dispatch", "audio.mix"
+};
+
+const char* COUNTER_NAMES[COUNTERS] = {
+    "engine.events", "ui.frames", "ui.draw_commands", "audio.sounds", "audio.voices_mixed"
+};
+
+// Written only by the owning thread; atomics just make the reader's
+// snapshot well defined, so plain load/store is enough
+struct ThreadBlock {
+    std::atomic<uint64_t> ticks[PHASES];
+    std::atomic<uint64_t> calls[PHASES];
+    std::atomic<uint64_t> counters[COUNTERS];
+
+    ThreadBlock() { clear(); }
+
+    void clear() {
+        for (int i = 0; i < PHASES; ++i) {
+            ticks[i].store(0, std::memory_order_relaxed);
+            calls[i].store(0, std::memory_order_relaxed);
+        }
+        for (int i = 0; i < COUNTERS; ++i) {
+            counters[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Blocks outlive their threads so work done by finished threads is reported
+std::mutex g_blocksMutex;
+std::vector<std::unique_ptr<ThreadBlock>>& blocks() {
+    static std::vector<std::unique_ptr<ThreadBlock>> all;
+    return all;
+}
+
+// Reference points for converting ticks to time
+const uint64_t g_startTicks = Profiler::now();
+const std::chrono::steady_clock::time_point g_startTime = std::chrono::steady_clock::now();
+
+ThreadBlock& localBlock() {
+    thread_local ThreadBlock* block = nullptr;
+    if (!block) {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        blocks().emplace_back(new ThreadBlock());
+        block = blocks().back().get();
+    }
+    return *block;
+}
+
+void add(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+} // namespace
+
+namespace Profiler {
+
+void addTime(ProfilePhase phase, uint64_t ticks) {
+    ThreadBlock& block = localBlock();
+    add(block.ticks[(int)phase], ticks);
+    add(block.calls[(int)phase], 1);
+}
+
+void addCount(ProfileCounter counter, uint64_t amount) {
+    add(localBlock().counters[(int)counter], amount);
+}
+
+void report(std::ostream& out) {
+    uint64_t ticks[PHASES] = {};
+    uint64_t calls[PHASES] = {};
+    uint64_t counters[COUNTERS] = {};
+    size_t threads;
+    {
+        std::lock_guard<std::mutex> lock(g_blocksMutex);
+        threads = blocks().size();
+        for (const auto& block : blocks()) {
+            for (int i = 0; i < PHASES; ++i) {
+                ticks[i] += block->ticks[i].load(std::memory_order_relaxed);
+                calls[i] += block->calls[i].load(std::memory_order_relaxed);
+            }
+            for (int i = 0; i < COUNTERS; ++i) {
+                counters[i] += block->counters[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    double elapsedNs = std::chrono::duration<double, std::nano>(
+                           std::chrono::steady_clock::now() - g_startTime).count();
+    double ticksPerNs = elapsedNs > 0 ? (now() - g_startTicks) / elapsedNs : 1.0;
+
+    char line[128];
+    snprintf(line, sizeof(line), "Profile: %zu thread(s), %.2f ticks/ns, inclusive times\n",
+             threads, ticksPerNs);
+    out << line;
+    snprintf(line, sizeof(line), "%-20s %12s %12s %12s\n", "phase", "calls", "total ms", "mean ns");
+    out << line;
+    for (int i = 0; i < PHASES; ++i) {
+        if (calls[i] == 0) {
+            continue;
+        }
+        double ns = ticks[i] / ticksPerNs;
+        snprintf(line, sizeof(line), "%-20s %12llu %12.3f %12.1f\n", PHASE_NAMES[i],
+                 (unsigned long long)calls[i], ns / 1e6, ns / calls[i]);
+        out << line;
+    }
+    for (int i = 0; i < COUNTERS; ++i) {
+        if (counters[i] == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%-20s %12llu\n", COUNTER_NAMES[i],
+                 (unsigned long long)counters[i]);
+        out << line;
+    }
+}
+
+void reset() {
+    std::lock_guard<std::mutex> lock(g_blocksMutex);
+    for (const auto& block : blocks()) {
+        block->clear();
+    }
+}
+
+} // namespace Profiler
+
+#endif // GOFISH_PROFILE
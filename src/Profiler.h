@@ -0,0 +1,100 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <ostream>
+
+// Hot-path timers and counters, compiled in only with -DGOFISH_PROFILE
+// (make profile). Without it every PROFILE_* macro expands to nothing.
+//
+// Each thread accumulates into its own block, so recording is a timestamp
+// read and two uncontended stores; Profiler::report() sums all threads.
+// Nested scopes are timed inclusively.
+
+enum class ProfilePhase {
+    ENGINE_STEP,
+    ENGINE_END_CHECK,
+    ENGINE_CHOOSE,
+    ENGINE_REQUEST,
+    ENGINE_TRANSFER,
+    ENGINE_DRAW,
+    ENGINE_BOOKS,
+    ENGINE_DISPATCH, // Event callbacks, i.e. UI and audio reacting to events
+    UI_EVENTS,
+    UI_UPDATE,
+    UI_RENDER,
+    UI_RENDER_CLEAR,
+    UI_RENDER_SCREEN,
+    UI_RENDER_OVERLAY,
+    UI_PRESENT,
+    AUDIO_DISPATCH,
+    AUDIO_MIX,
+    COUNT
+};
+
+enum class ProfileCounter {
+    ENGINE_EVENTS,
+    UI_FRAMES,
+    UI_DRAW_COMMANDS,
+    AUDIO_SOUNDS,
+    AUDIO_VOICES_MIXED, // Summed over periods
+    COUNT
+};
+
+#ifdef GOFISH_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+namespace Profiler {
+
+// Timestamp in backend ticks: TSC cycles on x86, nanoseconds elsewhere
+inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void addTime(ProfilePhase phase, uint64_t ticks);
+void addCount(ProfileCounter counter, uint64_t amount);
+
+// Per-phase calls, total and mean time, plus counters, for all threads
+void report(std::ostream& out);
+void reset();
+
+} // namespace Profiler
+
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase phase) : m_phase(phase), m_start(Profiler::now()) {}
+    ~ProfileScope() { Profiler::addTime(m_phase, Profiler::now() - m_start); }
+
+private:
+    ProfilePhase m_phase;
+    uint64_t m_start;
+};
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(ProfilePhase::phase)
+#define PROFILE_COUNT(counter, amount) Profiler::addCount(ProfileCounter::counter, (amount))
+
+#else
+
+namespace Profiler {
+inline void report(std::ostream&) {}
+inline void reset() {}
+} // namespace Profiler
+
+#define PROFILE_SCOPE(phase) ((void)0)
+#define PROFILE_COUNT(counter, amount) ((void)0)
+
+#endif // GOFISH_PROFILE
+
+#endif // PROFILER_H
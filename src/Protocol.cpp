@@ -0,0 +1,156 @@
+#include "Protocol.h"
+
+namespace Protocol {
+
+namespace {
+
+const int REPLY_SIZE = HEADER_SIZE + 12;
+const int EVENT_SIZE = HEADER_SIZE + 11;
+
+void put16(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+
+void put32(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+uint32_t get32(const uint8_t* in) {
+    return (uint32_t)in[0] | (uint32_t)in[1] << 8 | (uint32_t)in[2] << 16 | (uint32_t)in[3] << 24;
+}
+
+// Frame size of each request type, 0 for unknown types
+int requestSize(uint8_t type) {
+    switch (type) {
+        case CREATE_TABLE: return HEADER_SIZE + 8;
+        case NEW_GAME:     return HEADER_SIZE + 12;
+        case MOVE:         return HEADER_SIZE + 9;
+        case SUBSCRIBE:
+        case UNSUBSCRIBE:
+        case CLOSE_TABLE:  return HEADER_SIZE + 8;
+        default:           return 0;
+    }
+}
+
+int header(uint8_t* out, int size, uint8_t type) {
+    put16(out, (uint32_t)size);
+    out[2] = type;
+    return HEADER_SIZE;
+}
+
+} // namespace
+
+int encodeRequest(const Request& request, uint8_t* out) {
+    int size = requestSize(request.type);
+    uint8_t* p = out + header(out, size, request.type);
+    put32(p, request.tag);
+    p += 4;
+    if (request.type == CREATE_TABLE) {
+        put32(p, request.seed);
+        return size;
+    }
+    put32(p, request.table);
+    p += 4;
+    if (request.type == NEW_GAME) {
+        put32(p, request.seed);
+    } else if (request.type == MOVE) {
+        *p = request.rank;
+    }
+    return size;
+}
+
+int encodeReply(const Reply& reply, uint8_t* out) {
+    uint8_t* p = out + header(out, REPLY_SIZE, REPLY);
+    put32(p, reply.tag);
+    put32(p + 4, reply.table);
+    p[8] = reply.status;
+    p[9] = reply.turn;
+    p[10] = reply.books1;
+    p[11] = reply.books2;
+    return REPLY_SIZE;
+}
+
+int encodeEvent(const EventFrame& event, uint8_t* out) {
+    uint8_t* p = out + header(out, EVENT_SIZE, EVENT);
+    put32(p, event.table);
+    p[4] = event.type;
+    p[5] = (uint8_t)event.player;
+    p[6] = (uint8_t)event.opponent;
+    p[7] = event.rank;
+    p[8] = event.count;
+    p[9] = event.cardRank;
+    p[10] = event.cardSuit;
+    return EVENT_SIZE;
+}
+
+int frameSize(const uint8_t* data, size_t size) {
+    if (size < 2) {
+        return 0;
+    }
+    int frame = data[0] | data[1] << 8;
+    if (frame < HEADER_SIZE || frame > MAX_FRAME) {
+        return -1;
+    }
+    return (size_t)frame <= size ? frame : 0;
+}
+
+bool decodeRequest(const uint8_t* frame, int size, Request& request) {
+    uint8_t type = frame[2];
+    int expected = requestSize(type);
+    if (expected == 0 || size != expected) {
+        return false;
+    }
+    const uint8_t* p = frame + HEADER_SIZE;
+    request.type = type;
+    request.tag = get32(p);
+    request.table = 0;
+    request.seed = 0;
+    request.rank = 0;
+    if (type == CREATE_TABLE) {
+        request.seed = get32(p + 4);
+        return true;
+    }
+    request.table = get32(p + 4);
+    if (type == NEW_GAME) {
+        request.seed = get32(p + 8);
+    } else if (type == MOVE) {
+        request.rank = p[8];
+    }
+    return true;
+}
+
+bool decodeReply(const uint8_t* frame, int size, Reply& reply) {
+    if (size != REPLY_SIZE || frame[2] != REPLY) {
+        return false;
+    }
+    const uint8_t* p = frame + HEADER_SIZE;
+    reply.tag = get32(p);
+    reply.table = get32(p + 4);
+    reply.status = p[8];
+    reply.turn = p[9];
+    reply.books1 = p[10];
+    reply.books2 = p[11];
+    return true;
+}
+
+bool decodeEvent(const uint8_t* frame, int size, EventFrame& event) {
+    if (size != EVENT_SIZE || frame[2] != EVENT) {
+        return false;
+    }
+    const uint8_t* p = frame + HEADER_SIZE;
+    event.table = get32(p);
+    event.type = p[4];
+    event.player = (int8_t)p[5];
+    event.opponent = (int8_t)p[6];
+    event.rank = p[7];
+    event.count = p[8];
+    event.cardRank = p[9];
+    event.cardSuit = p[10];
+    return true;
+}
+
+} // namespace Protocol
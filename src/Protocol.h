@@ -0,0 +1,94 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Binary protocol between gofish-server and its clients over a local
+// stream socket. Every frame is a 2-byte length (of the whole frame,
+// little-endian), a 1-byte message type and a fixed payload for that type:
+//
+//   CREATE_TABLE  tag, seed          -> REPLY with the new table id
+//   NEW_GAME      tag, table, seed   -> REPLY; deals a fresh game
+//   MOVE          tag, table, rank   -> REPLY; the player to move asks for
+//                                       rank, 0 for the built-in choice
+//   SUBSCRIBE     tag, table         -> REPLY, then EVENT frames
+//   UNSUBSCRIBE   tag, table         -> REPLY
+//   CLOSE_TABLE   tag, table         -> REPLY
+//
+// tag is chosen by the client and echoed in the reply; all integers are
+// 32-bit little-endian apart from rank. Requests on one table are answered
+// in order; requests on different tables may be answered out of order.
+namespace Protocol {
+
+const char* const DEFAULT_SOCKET = "/tmp/gofish.sock";
+const int HEADER_SIZE = 3;
+const int MAX_FRAME = 24;
+
+enum MessageType : uint8_t {
+    CREATE_TABLE = 1,
+    NEW_GAME = 2,
+    MOVE = 3,
+    SUBSCRIBE = 4,
+    UNSUBSCRIBE = 5,
+    CLOSE_TABLE = 6,
+    REPLY = 64,
+    EVENT = 65
+};
+
+enum Status : uint8_t {
+    OK,
+    GAME_OVER,   // No move made: the game has ended
+    NO_TABLE,
+    BAD_REQUEST,
+    BUSY         // Too many subscribers on the table
+};
+
+struct Request {
+    uint8_t type;
+    uint32_t tag;
+    uint32_t table;
+    uint32_t seed;
+    uint8_t rank;
+};
+
+// Table state after the request
+struct Reply {
+    uint32_t tag;
+    uint32_t table;
+    uint8_t status;
+    uint8_t turn;   // Player to move, 0 = AI1
+    uint8_t books1;
+    uint8_t books2;
+};
+
+// A GameEvent without the strings; players are 0 (AI1), 1 (AI2), 2 for a
+// tied GAME_ENDED, or -1 for none
+struct EventFrame {
+    uint32_t table;
+    uint8_t type;   // EventType
+    int8_t player;
+    int8_t opponent;
+    uint8_t rank;
+    uint8_t count;
+    uint8_t cardRank;
+    uint8_t cardSuit;
+};
+
+// Each returns the frame size written to out (at least MAX_FRAME bytes)
+int encodeRequest(const Request& request, uint8_t* out);
+int encodeReply(const Reply& reply, uint8_t* out);
+int encodeEvent(const EventFrame& event, uint8_t* out);
+
+// Size of the complete frame at the start of data, 0 if more bytes are
+// needed, -1 if the data cannot be a frame
+int frameSize(const uint8_t* data, size_t size);
+
+// Decode one complete frame; false if its type or length is wrong
+bool decodeRequest(const uint8_t* frame, int size, Request& request);
+bool decodeReply(const uint8_t* frame, int size, Reply& reply);
+bool decodeEvent(const uint8_t* frame, int size, EventFrame& event);
+
+} // namespace Protocol
+
+#endif // PROTOCOL_H
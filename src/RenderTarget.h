@@ -0,0 +1,26 @@
+#ifndef RENDERTARGET_H
+#define RENDERTARGET_H
+
+// Drawing surface used by UIManager. Colors are opaque pixel values obtained
+// from allocateColor(), so each backend can use its native representation.
+class RenderTarget {
+public:
+    virtual ~RenderTarget() {}
+
+    virtual unsigned long allocateColor(int r, int g, int b) = 0;
+    virtual unsigned long blackPixel() const = 0;
+    virtual unsigned long whitePixel() const = 0;
+
+    virtual void setColor(unsigned long pixel) = 0;
+    virtual void fillRect(int x, int y, int width, int height) = 0;
+    virtual void drawRect(int x, int y, int width, int height) = 0;
+    virtual void drawText(int x, int y, const char* text, int length) = 0; // y = baseline
+
+    virtual void resize(int width, int height) = 0;
+    virtual void present() = 0; // Make the finished frame visible
+
+    // Total number of drawing primitives issued so far
+    virtual int commandCount() const = 0;
+};
+
+#endif // RENDERTARGET_H
@@ -0,0 +1,252 @@
+#include "Replay.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+const char* const REPLAY_MAGIC = "gofish-replay";
+const int REPLAY_VERSION = 1;
+const char* const CARD_RANKS[14] = {"", "A", "2", "3", "4", "5", "6", "7", "8", "9", "10",
+                                    "J", "Q", "K"};
+const char CARD_SUITS[4] = {'h', 'd', 'c', 's'};
+
+// "10h", "Qs"; "-" for no card
+std::string cardToken(const Card& card) {
+    if (card.rank < 1 || card.rank > 13) {
+        return "-";
+    }
+    return std::string(CARD_RANKS[card.rank]) + CARD_SUITS[card.suit];
+}
+
+bool parseCard(const std::string& token, Card& card) {
+    card = Card{0, 0};
+    if (token == "-") {
+        return true;
+    }
+    if (token.size() < 2) {
+        return false;
+    }
+    std::string rank = token.substr(0, token.size() - 1);
+    int suit = -1;
+    for (int s = 0; s < 4; ++s) {
+        if (token.back() == CARD_SUITS[s]) {
+            suit = s;
+        }
+    }
+    for (int r = 1; r <= 13 && suit >= 0; ++r) {
+        if (rank == CARD_RANKS[r]) {
+            card = Card{r, suit};
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string nameToken(const std::string& name) {
+    return name.empty() ? "-" : name;
+}
+
+bool sameEvent(const GameEvent& a, const GameEvent& b) {
+    return a.type == b.type && a.player == b.player && a.opponent == b.opponent &&
+           a.rank == b.rank && a.count == b.count && a.drawnCard.rank == b.drawnCard.rank &&
+           a.drawnCard.suit == b.drawnCard.suit;
+}
+
+bool readEvent(std::istream& in, GameEvent& event) {
+    std::string type, player, opponent, card;
+    if (!(in >> type >> player >> opponent >> event.rank >> event.count >> card)) {
+        return false;
+    }
+    bool known = false;
+    for (int t = 0; t <= (int)EventType::GAME_ENDED && !known; ++t) {
+        if (type == eventTypeName((EventType)t)) {
+            event.type = (EventType)t;
+            known = true;
+        }
+    }
+    event.player = player == "-" ? "" : player;
+    event.opponent = opponent == "-" ? "" : opponent;
+    return known && parseCard(card, event.drawnCard);
+}
+
+} // namespace
+
+Replay::Replay(int keyframeEvents) : m_keyframeEvents(std::max(1, keyframeEvents)) {
+}
+
+bool Replay::loadSeed(unsigned int seed) {
+    // Rebuild the deck from the deal: each hand, with any book it was dealt,
+    // then the pile in drawing order
+    QuietGameEngine dealer;
+    dealer.setSeed(seed);
+    dealer.startNewGame();
+    GameSnapshot dealt = dealer.snapshot();
+    CardList deck;
+    for (int p = 0; p < 2; ++p) {
+        for (const Card& card : p == 0 ? dealt.hand1 : dealt.hand2) {
+            deck.push_back(card);
+        }
+        for (int r = 1; r <= 13; ++r) {
+            if (dealt.bookRanks[p] & (1u << r)) {
+                for (int suit = 0; suit < 4; ++suit) {
+                    deck.push_back(Card{r, suit});
+                }
+            }
+        }
+    }
+    for (const Card& card : dealt.drawPile) {
+        deck.push_back(card);
+    }
+    record(deck);
+    return true;
+}
+
+bool Replay::loadFile(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot open replay " << path << std::endl;
+        return false;
+    }
+    std::string magic, section;
+    int version = 0;
+    in >> magic >> version >> section;
+    if (magic != REPLAY_MAGIC || version != REPLAY_VERSION || section != "deal") {
+        std::cerr << path << ": not a version " << REPLAY_VERSION << " replay" << std::endl;
+        return false;
+    }
+
+    CardList deck;
+    bool seen[14][4] = {{false}};
+    for (int i = 0; i < CardList::CAPACITY; ++i) {
+        std::string token;
+        Card card;
+        if (!(in >> token) || !parseCard(token, card) || card.rank == 0 ||
+            seen[card.rank][card.suit]) {
+            std::cerr << path << ": the deal is not a full deck" << std::endl;
+            return false;
+        }
+        seen[card.rank][card.suit] = true;
+        deck.push_back(card);
+    }
+    record(deck);
+
+    // The log is optional, but if present it must be the game the deal plays
+    int count = 0;
+    if (!(in >> section)) {
+        return true;
+    }
+    if (section != "events" || !(in >> count)) {
+        std::cerr << path << ": expected the event log after the deal" << std::endl;
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        GameEvent event;
+        if (!readEvent(in, event)) {
+            std::cerr << path << ": bad event " << i << std::endl;
+            return false;
+        }
+        if (i >= end() || !sameEvent(event, m_events[i])) {
+            std::cerr << path << ": event " << i << " does not follow from the deal" << std::endl;
+            return false;
+        }
+    }
+    if (count != end()) {
+        std::cerr << path << ": the log stops after " << count << " of " << end() << " events"
+                  << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool Replay::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Cannot write replay " << path << std::endl;
+        return false;
+    }
+    out << REPLAY_MAGIC << ' ' << REPLAY_VERSION << "\ndeal";
+    for (const Card& card : m_deal) {
+        out << ' ' << cardToken(card);
+    }
+    out << "\nevents " << m_events.size() << '\n';
+    char line[96];
+    for (const GameEvent& event : m_events) {
+        snprintf(line, sizeof(line), "%s %s %s %d %d %s\n", eventTypeName(event.type),
+                 nameToken(event.player).c_str(), nameToken(event.opponent).c_str(), event.rank,
+                 event.count, cardToken(event.drawnCard).c_str());
+        out << line;
+    }
+    return (bool)out;
+}
+
+int Replay::turnAt(int position) const {
+    return (int)(std::upper_bound(m_turnStarts.begin(), m_turnStarts.end(), position) -
+                 m_turnStarts.begin()) - 1;
+}
+
+size_t Replay::memoryBytes() const {
+    return sizeof(*this) + m_events.capacity() * sizeof(GameEvent) +
+           m_turnStarts.capacity() * sizeof(int) + m_keyframes.capacity() * sizeof(Keyframe);
+}
+
+GameSnapshot Replay::seek(int position) {
+    if (m_keyframes.empty()) {
+        return m_engine.snapshot();
+    }
+    position = std::max(start(), std::min(end(), position));
+    auto next = std::upper_bound(m_keyframes.begin(), m_keyframes.end(), position,
+        [](int p, const Keyframe& keyframe) { return p < keyframe.position; });
+    const Keyframe& keyframe = *(next - 1);
+    m_engine.restore(keyframe.state);
+
+    // Abandoning a turn part way leaves the engine as it was at that event.
+    // At a turn boundary the turn is run to its end, which passes the move
+    // as the keyframes do, without another event.
+    bool boundary = position == end() ||
+                    std::binary_search(m_turnStarts.begin(), m_turnStarts.end(), position);
+    int remaining = position - keyframe.position;
+    while (remaining > 0) {
+        Generator<EventType> turn = m_engine.playTurn();
+        int before = remaining;
+        while (remaining > 0 && turn.next()) {
+            --remaining;
+        }
+        if (remaining == before) {
+            break; // Game over; cannot happen for positions up to end()
+        }
+        if (remaining == 0 && boundary) {
+            turn.next();
+        }
+    }
+    return m_engine.snapshot();
+}
+
+void Replay::record(const CardList& deck) {
+    m_deal = deck;
+    m_turnStarts.clear();
+    m_keyframes.clear();
+
+    BasicGameEngine<RecordingSink> recorder;
+    recorder.startNewGame(deck);
+    int lastKeyframe = -m_keyframeEvents;
+    while (true) {
+        int position = (int)recorder.sink().events.size();
+        if (position - lastKeyframe >= m_keyframeEvents) {
+            m_keyframes.push_back(Keyframe{position, recorder.snapshot()});
+            lastKeyframe = position;
+        }
+        Generator<EventType> turn = recorder.playTurn();
+        if (!turn.next()) {
+            break;
+        }
+        m_turnStarts.push_back(position);
+        while (turn.next()) {
+        }
+        if (recorder.getGameState() != GameState::PLAYING) {
+            break;
+        }
+    }
+    m_events = std::move(recorder.sink().events);
+}
@@ -0,0 +1,61 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <string>
+#include <vector>
+#include "GameEngine.h"
+
+// A finished game held for scrubbing back and forth. Loading plays the
+// whole game once, recording its events and, at the first turn boundary
+// after every K events, a keyframe snapshot of the engine. A position is a
+// number of events played; seek() restores the last keyframe at or before
+// it and replays the rest with playTurn(), so any position costs at most
+// K events plus one turn of play however long the game is.
+//
+// A replay comes from a seed (the game the GUI deals with --seed) or from
+// a file written by save(): the deal followed by the event log, which
+// loading checks against the game the deal produces.
+class Replay {
+public:
+    static const int DEFAULT_KEYFRAME_EVENTS = 16;
+
+    explicit Replay(int keyframeEvents = DEFAULT_KEYFRAME_EVENTS);
+
+    bool loadSeed(unsigned int seed);
+    bool loadFile(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Positions run from start(), just after GAME_STARTED, to end()
+    int start() const { return m_keyframes.empty() ? 0 : m_keyframes[0].position; }
+    int end() const { return (int)m_events.size(); }
+    const GameEvent& event(int index) const { return m_events[index]; }
+
+    // Turn t runs from turnStart(t); the last "turn" is GAME_ENDED
+    int turnCount() const { return (int)m_turnStarts.size(); }
+    int turnStart(int turn) const { return m_turnStarts[turn]; }
+    int turnAt(int position) const; // The turn under way at position, -1 before the first
+
+    int keyframeCount() const { return (int)m_keyframes.size(); }
+    size_t memoryBytes() const;
+
+    // State after the first position events, clamped to start()..end(); at
+    // a turn start, the previous turn is over and the next player to move
+    GameSnapshot seek(int position);
+
+private:
+    struct Keyframe {
+        int position;
+        GameSnapshot state;
+    };
+
+    void record(const CardList& deck);
+
+    int m_keyframeEvents;
+    CardList m_deal;
+    std::vector<GameEvent> m_events;
+    std::vector<int> m_turnStarts;
+    std::vector<Keyframe> m_keyframes;
+    QuietGameEngine m_engine; // Replays from keyframes
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,85 @@
+#include "SoundBank.h"
+#include "WavFile.h"
+#include <iostream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SoundBank::SoundBank() {
+}
+
+SoundId SoundBank::load(const std::string& name, const std::string& path) {
+    SoundId existing = find(name);
+    if (existing != INVALID_SOUND) {
+        return existing;
+    }
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Warning: cannot open sound " << path << std::endl;
+        return INVALID_SOUND;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        std::cerr << "Warning: " << path << ": empty or unreadable" << std::endl;
+        return INVALID_SOUND;
+    }
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Warning: cannot map sound " << path << std::endl;
+        return INVALID_SOUND;
+    }
+
+    // Parse straight from the mapping and convert into resident samples
+    WavInfo info;
+    std::string error;
+    std::vector<int16_t> pcm;
+    bool ok = parseWav((const uint8_t*)mapping, st.st_size, info, error);
+    if (ok) {
+        convertWav(info, m_format, pcm);
+    }
+    munmap(mapping, st.st_size);
+    if (!ok) {
+        std::cerr << "Warning: " << path << ": " << error << std::endl;
+        return INVALID_SOUND;
+    }
+
+    // Moving the vectors on growth keeps each sample buffer in place
+    SoundId id = m_sounds.size();
+    m_sounds.push_back(Sound());
+    m_sounds[id].name = name;
+    m_sounds[id].pcm.swap(pcm);
+    return id;
+}
+
+int SoundBank::loadDirectory(const std::string& directory) {
+    DIR* dir = opendir(directory.c_str());
+    if (!dir) {
+        return 0;
+    }
+    int loaded = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string file = entry->d_name;
+        if (file.size() <= 4 || file.compare(file.size() - 4, 4, ".wav") != 0) {
+            continue;
+        }
+        if (load(file.substr(0, file.size() - 4), directory + "/" + file) != INVALID_SOUND) {
+            ++loaded;
+        }
+    }
+    closedir(dir);
+    return loaded;
+}
+
+SoundId SoundBank::find(const std::string& name) const {
+    for (size_t i = 0; i < m_sounds.size(); ++i) {
+        if (m_sounds[i].name == name) {
+            return (SoundId)i;
+        }
+    }
+    return INVALID_SOUND;
+}
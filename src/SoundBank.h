@@ -0,0 +1,51 @@
+#ifndef SOUNDBANK_H
+#define SOUNDBANK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioSink.h"
+
+typedef int SoundId;
+const SoundId INVALID_SOUND = -1;
+
+// Sounds decoded once at startup and kept resident in the mixer's output
+// format. Names are interned to small integer IDs so playback needs no
+// string handling or file I/O.
+class SoundBank {
+public:
+    SoundBank();
+
+    void setFormat(const AudioFormat& format) { m_format = format; }
+
+    // Map, validate and convert a WAV file. A name that is already loaded
+    // keeps its samples so playing voices never see them move.
+    // Returns INVALID_SOUND on error.
+    SoundId load(const std::string& name, const std::string& path);
+
+    // Load every *.wav in `directory` under its file name without extension;
+    // returns the number of sounds loaded
+    int loadDirectory(const std::string& directory);
+
+    SoundId find(const std::string& name) const;
+
+    int size() const { return (int)m_sounds.size(); }
+    const std::string& name(SoundId id) const { return m_sounds[id].name; }
+
+    // Interleaved samples in the output format; valid until the bank is destroyed
+    const int16_t* samples(SoundId id) const { return m_sounds[id].pcm.data(); }
+    size_t sampleCount(SoundId id) const { return m_sounds[id].pcm.size(); }
+
+    bool isValid(SoundId id) const { return id >= 0 && id < (int)m_sounds.size(); }
+
+private:
+    struct Sound {
+        std::string name;
+        std::vector<int16_t> pcm;
+    };
+
+    AudioFormat m_format;
+    std::vector<Sound> m_sounds; // Indexed by SoundId
+};
+
+#endif // SOUNDBANK_H
@@ -0,0 +1,96 @@
+#include "Strategy.h"
+
+namespace {
+
+// Held count of each rank the player may ask for, zero for the others
+void askableCounts(const TurnView& view, int counts[14]) {
+    for (int r = 0; r < 14; ++r) {
+        counts[r] = 0;
+    }
+    for (const Card& c : view.hand) {
+        if (!(view.denied & (1u << c.rank))) {
+            ++counts[c.rank];
+        }
+    }
+}
+
+int chooseLowest(const TurnView& view) {
+    int counts[14];
+    askableCounts(view, counts);
+    for (int r = 1; r <= 13; ++r) {
+        if (counts[r] > 0) return r;
+    }
+    return 0;
+}
+
+int chooseHighest(const TurnView& view) {
+    int counts[14];
+    askableCounts(view, counts);
+    for (int r = 13; r >= 1; --r) {
+        if (counts[r] > 0) return r;
+    }
+    return 0;
+}
+
+// The rank closest to a book; ties go to the lowest rank
+int chooseMost(const TurnView& view) {
+    int counts[14];
+    askableCounts(view, counts);
+    int best = 0;
+    for (int r = 1; r <= 13; ++r) {
+        if (counts[r] > counts[best]) best = r;
+    }
+    return best;
+}
+
+// The rank least likely to be asked for back; ties go to the lowest rank
+int chooseFewest(const TurnView& view) {
+    int counts[14];
+    askableCounts(view, counts);
+    int best = 0;
+    for (int r = 1; r <= 13; ++r) {
+        if (counts[r] > 0 && (best == 0 || counts[r] < counts[best])) best = r;
+    }
+    return best;
+}
+
+// Uses what the opponent has revealed: first a rank they certainly hold,
+// the one we hold most of so it is closest to a book; then one they may
+// hold, the one we hold fewest of as more of it is unseen; otherwise the
+// fewest-held rank anyway, for the draw
+int chooseTracker(const TurnView& view) {
+    int counts[14];
+    askableCounts(view, counts);
+    int sure = 0;
+    int maybe = 0;
+    int any = 0;
+    for (int r = 1; r <= 13; ++r) {
+        if (counts[r] == 0) continue;
+        uint16_t bit = (uint16_t)(1u << r);
+        if ((view.opponentHolds & bit) && (sure == 0 || counts[r] > counts[sure])) sure = r;
+        if ((view.opponentMayHold & bit) && (maybe == 0 || counts[r] < counts[maybe])) maybe = r;
+        if (any == 0 || counts[r] < counts[any]) any = r;
+    }
+    return sure ? sure : maybe ? maybe : any;
+}
+
+} // namespace
+
+const Strategy STRATEGIES[] = {
+    {"lowest", "Lowest rank not denied (the default AI)", chooseLowest},
+    {"highest", "Highest rank not denied", chooseHighest},
+    {"most", "Rank with the most cards in hand", chooseMost},
+    {"fewest", "Rank with the fewest cards in hand", chooseFewest},
+    {"tracker", "Tracks what the opponent revealed, see BeliefState", chooseTracker},
+};
+
+const int STRATEGY_COUNT = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+
+const Strategy* findStrategy(const std::string& name) {
+    for (int i = 0; i < STRATEGY_COUNT; ++i) {
+        if (name == STRATEGIES[i].name) {
+            return &STRATEGIES[i];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,37 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <cstdint>
+#include <string>
+#include "CardList.h"
+
+// What a player can see when choosing a rank to ask for
+struct TurnView {
+    const CardList& hand; // Sorted, never empty
+    uint16_t denied;      // Bit r set: the opponent has no rank r
+    uint16_t opponentHolds;   // Public knowledge, see BeliefState
+    uint16_t opponentMayHold;
+    int opponentCards;
+    int pileCards;
+    int books;
+    int opponentBooks;
+};
+
+// Returns a rank from the hand that is not denied. Anything else makes the
+// engine fall back to its own choice, the lowest such rank.
+typedef int (*RankChooser)(const TurnView& view);
+
+struct Strategy {
+    const char* name;
+    const char* description;
+    RankChooser choose;
+};
+
+// The built-in strategies; "lowest" plays exactly like the default engine
+extern const Strategy STRATEGIES[];
+extern const int STRATEGY_COUNT;
+
+// Null if there is no strategy of that name
+const Strategy* findStrategy(const std::string& name);
+
+#endif // STRATEGY_H
@@ -0,0 +1,187 @@
+#include "TableGrid.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Tables that finished wait this many turn delays before dealing again
+const float RESTART_DELAY_TURNS = 2.0f;
+
+// Steps a single table may take per frame at very high speeds
+const int MAX_TABLE_STEPS_PER_FRAME = 64;
+
+// Minimum cell sizes (pixels wide) for each detail level
+const int CARDS_DETAIL_WIDTH = 72;
+const int FULL_DETAIL_WIDTH = 200;
+
+TableGrid::TableGrid(int columns, int rows, unsigned int seed)
+    : m_columns(columns), m_rows(rows), m_x(0), m_y(0), m_width(0), m_height(0),
+      m_tables(columns * rows), m_gamesFinished(0), m_stepsTaken(0) {
+    for (size_t i = 0; i < m_tables.size(); ++i) {
+        Table& table = m_tables[i];
+        table.engine.setSeed(seed + i);
+        table.engine.startNewGame();
+        // Stagger the tables so they don't all step on the same frame
+        table.timer = (float)i / m_tables.size();
+        table.dirty = true;
+    }
+}
+
+void TableGrid::setViewport(int x, int y, int width, int height) {
+    m_x = x;
+    m_y = y;
+    m_width = width;
+    m_height = height;
+    for (auto& table : m_tables) {
+        table.dirty = true;
+    }
+}
+
+bool TableGrid::update(float deltaTime, float speed, float turnDelay) {
+    bool changed = false;
+    float interval = turnDelay / speed;
+    for (auto& table : m_tables) {
+        // Timers are kept in units of turn intervals
+        table.timer += deltaTime / interval;
+        // Only steps and restarts count, so a table waiting out its restart
+        // delay stays clean
+        int steps = 0;
+        while (table.timer >= 1.0f && steps < MAX_TABLE_STEPS_PER_FRAME) {
+            if (table.engine.getGameState() == GameState::PLAYING) {
+                ++steps;
+                table.timer -= 1.0f;
+                ++m_stepsTaken;
+                if (!table.engine.stepGame()) {
+                    ++m_gamesFinished;
+                }
+            } else if (table.timer >= RESTART_DELAY_TURNS) {
+                ++steps;
+                table.timer -= RESTART_DELAY_TURNS;
+                table.engine.startNewGame();
+            } else {
+                break;
+            }
+        }
+        if (steps == MAX_TABLE_STEPS_PER_FRAME) {
+            table.timer = 0.0f;
+        }
+        if (steps > 0) {
+            table.dirty = true;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void TableGrid::render(RenderTarget& target, const TablePalette& palette, bool fullRedraw) {
+    if (m_columns <= 0 || m_rows <= 0) return;
+    int cellW = m_width / m_columns;
+    int cellH = m_height / m_rows;
+
+    for (int row = 0; row < m_rows; ++row) {
+        for (int col = 0; col < m_columns; ++col) {
+            Table& table = m_tables[row * m_columns + col];
+            if (!fullRedraw && !table.dirty) {
+                continue;
+            }
+            table.dirty = false;
+            drawTable(target, palette, table.engine,
+                      m_x + col * cellW, m_y + row * cellH, cellW, cellH);
+        }
+    }
+}
+
+void TableGrid::drawTable(RenderTarget& target, const TablePalette& palette,
+                          const QuietGameEngine& engine, int x, int y, int w, int h) const {
+    // Clear the cell and draw its border
+    target.setColor(palette.table);
+    target.fillRect(x, y, w, h);
+    target.setColor(palette.border);
+    target.drawRect(x, y, w - 1, h - 1);
+
+    DetailLevel detail = w >= FULL_DETAIL_WIDTH ? DETAIL_FULL :
+                         w >= CARDS_DETAIL_WIDTH ? DETAIL_CARDS : DETAIL_MINIMAL;
+    int pad = std::max(2, w / 32);
+    int innerW = w - 2 * pad;
+    int textH = detail == DETAIL_FULL ? 12 : 0;
+    int handH = (h - 2 * pad - textH) * 2 / 5;
+
+    // AI2 on top (face down), AI1 at the bottom (face up)
+    drawHand(target, palette, engine.getHand2(), true, detail,
+             x + pad, y + pad, innerW, handH);
+    drawHand(target, palette, engine.getHand1(), false, detail,
+             x + pad, y + h - pad - textH - handH, innerW, handH);
+
+    // Draw pile as a bar in the middle, scaled to the cards left
+    int pileH = std::max(1, handH / 4);
+    int pileY = y + pad + handH + (h - 2 * pad - textH - 2 * handH - pileH) / 2;
+    int pileW = innerW * (int)engine.getDrawPile().size() / 38;
+    target.setColor(palette.cardBack);
+    target.fillRect(x + pad, pileY, std::min(pileW, innerW), pileH);
+
+    if (detail == DETAIL_FULL) {
+        char status[64];
+        if (engine.getGameState() == GameState::GAME_OVER) {
+            snprintf(status, sizeof(status), "Winner: %s  %d-%d", engine.getWinner().c_str(),
+                     engine.getBooks1(), engine.getBooks2());
+        } else {
+            snprintf(status, sizeof(status), "Books %d-%d  Pile %d  %s",
+                     engine.getBooks1(), engine.getBooks2(),
+                     (int)engine.getDrawPile().size(), engine.getCurrentTurn().c_str());
+        }
+        target.setColor(palette.text);
+        drawLabel(target, x + pad, y + h - pad, status);
+    } else if (engine.getGameState() == GameState::GAME_OVER) {
+        // Finished tables get a highlighted frame instead of text
+        target.setColor(palette.text);
+        target.drawRect(x + 1, y + 1, w - 3, h - 3);
+    }
+}
+
+void TableGrid::drawHand(RenderTarget& target, const TablePalette& palette,
+                         const CardList& hand, bool faceDown, DetailLevel detail,
+                         int x, int y, int w, int h) const {
+    int n = hand.size();
+    if (n == 0) return;
+
+    if (detail == DETAIL_MINIMAL) {
+        target.setColor(faceDown ? palette.cardBack : palette.cardFace);
+        target.fillRect(x, y, std::min(w, w * n / 20), h);
+        return;
+    }
+
+    // Scaled-down sprites, overlapping once the hand outgrows the row
+    int cardH = h;
+    int cardW = std::max(3, std::min(cardH * 2 / 3, w / 8));
+    int stride = n > 1 ? std::min(cardW + 1, (w - cardW) / (n - 1)) : 0;
+    stride = std::max(1, stride);
+    bool showRanks = detail == DETAIL_FULL && stride >= 12;
+
+    for (int i = 0; i < n; ++i) {
+        int cx = x + i * stride;
+        if (faceDown) {
+            target.setColor(palette.cardBack);
+            target.fillRect(cx, y, cardW, cardH);
+            target.setColor(palette.border);
+            target.drawRect(cx, y, cardW, cardH);
+            continue;
+        }
+        const Card& card = hand[i];
+        unsigned long suitColor = card.suit < 2 ? palette.red : palette.black;
+        target.setColor(palette.cardFace);
+        target.fillRect(cx, y, cardW, cardH);
+        target.setColor(suitColor);
+        target.drawRect(cx, y, cardW, cardH);
+        if (showRanks) {
+            std::string rank = GameEngine::rankToStr(card.rank);
+            target.drawText(cx + 2, y + 10, rank.c_str(), rank.size() > 2 ? 1 : rank.size());
+        } else {
+            // Suit-colored pip instead of text
+            target.fillRect(cx + cardW / 4, y + cardH / 3, std::max(1, cardW / 2),
+                            std::max(1, cardH / 3));
+        }
+    }
+}
+
+void TableGrid::drawLabel(RenderTarget& target, int x, int y, const char* text) const {
+    target.drawText(x, y, text, strlen(text));
+}
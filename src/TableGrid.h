@@ -0,0 +1,67 @@
+#ifndef TABLEGRID_H
+#define TABLEGRID_H
+
+#include <vector>
+#include "GameEngine.h"
+#include "RenderTarget.h"
+
+// Pixel values the grid draws with (allocated by UIManager)
+struct TablePalette {
+    unsigned long table;
+    unsigned long border;
+    unsigned long cardFace;
+    unsigned long cardBack;
+    unsigned long red;
+    unsigned long black;
+    unsigned long text;
+};
+
+// Spectator view of many independent AI vs AI tables laid out in a grid.
+// Every table owns its GameEngine and is only repainted when its state
+// changed; the level of detail drops as the cells get smaller.
+class TableGrid {
+public:
+    TableGrid(int columns, int rows, unsigned int seed);
+
+    void setViewport(int x, int y, int width, int height);
+
+    // Advance every table's turn timer; returns true if any table changed
+    bool update(float deltaTime, float speed, float turnDelay);
+
+    // Paint dirty tables (or all of them when fullRedraw is set)
+    void render(RenderTarget& target, const TablePalette& palette, bool fullRedraw);
+
+    int columns() const { return m_columns; }
+    int rows() const { return m_rows; }
+    long gamesFinished() const { return m_gamesFinished; }
+    long stepsTaken() const { return m_stepsTaken; }
+
+private:
+    struct Table {
+        QuietGameEngine engine;
+        float timer;
+        bool dirty;
+    };
+
+    enum DetailLevel {
+        DETAIL_MINIMAL, // Hand-size bars only
+        DETAIL_CARDS,   // Small card sprites, no text
+        DETAIL_FULL     // Card sprites with ranks and scores
+    };
+
+    int m_columns;
+    int m_rows;
+    int m_x, m_y, m_width, m_height;
+    std::vector<Table> m_tables;
+    long m_gamesFinished;
+    long m_stepsTaken;
+
+    void drawTable(RenderTarget& target, const TablePalette& palette,
+                   const QuietGameEngine& engine, int x, int y, int w, int h) const;
+    void drawHand(RenderTarget& target, const TablePalette& palette,
+                  const CardList& hand, bool faceDown, DetailLevel detail,
+                  int x, int y, int w, int h) const;
+    void drawLabel(RenderTarget& target, int x, int y, const char* text) const;
+};
+
+#endif // TABLEGRID_H
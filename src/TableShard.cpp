@@ -0,0 +1,259 @@
+#include "TableShard.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include "Tracer.h"
+
+namespace {
+
+const int NOTIFY_BATCH = 256; // Commands executed between wake-ups of the I/O thread
+
+// Rank the current MOVE asks for; tables run one at a time on their shard,
+// so the chooser both seats use can read it from here
+thread_local int t_submittedRank = 0;
+
+int submittedRank(const TurnView&) {
+    return t_submittedRank; // 0 or a rank the player may not ask for: engine's choice
+}
+
+int playerIndex(const std::string& name) {
+    if (name == "AI1") return 0;
+    if (name == "AI2") return 1;
+    if (name == "Tie") return 2;
+    return -1;
+}
+
+void signalFd(int fd) {
+    uint64_t one = 1;
+    ssize_t written = write(fd, &one, sizeof(one));
+    (void)written; // Fails only when the counter is saturated, i.e. already signaled
+}
+
+} // namespace
+
+TableShard::TableShard(int index, int shards, int ioWakeFd)
+    : m_index(index), m_shards(shards), m_wakeFd(eventfd(0, EFD_CLOEXEC)), m_ioWakeFd(ioWakeFd),
+      m_sleeping(false), m_outputPending(false), m_running(false), m_tableCount(0), m_moves(0),
+      m_events(0) {
+}
+
+void* TableShard::operator new(size_t size) {
+    void* pointer = nullptr;
+    if (posix_memalign(&pointer, alignof(TableShard), size) != 0) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void TableShard::operator delete(void* pointer) {
+    free(pointer);
+}
+
+TableShard::~TableShard() {
+    stop();
+    if (m_wakeFd >= 0) {
+        close(m_wakeFd);
+    }
+}
+
+void TableShard::start() {
+    m_running.store(true);
+    m_thread = std::thread(&TableShard::run, this);
+}
+
+void TableShard::stop() {
+    if (m_thread.joinable()) {
+        m_running.store(false);
+        signalFd(m_wakeFd);
+        m_thread.join();
+    }
+}
+
+void TableShard::wake() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.exchange(false)) {
+        signalFd(m_wakeFd);
+    }
+}
+
+void TableShard::run() {
+    char name[32];
+    snprintf(name, sizeof(name), "shard %d", m_index);
+    Tracer::setThreadName(name);
+    ShardCommand command;
+    while (m_running.load(std::memory_order_relaxed)) {
+        int executed = 0;
+        while (m_commands.pop(command)) {
+            execute(command);
+            if (++executed % NOTIFY_BATCH == 0) {
+                notifyIo();
+            }
+        }
+        if (executed > 0) {
+            notifyIo();
+            continue;
+        }
+        // Nothing to do: sleep unless a command arrived after the last pop
+        m_sleeping.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_commands.size() == 0 && m_running.load()) {
+            uint64_t count;
+            ssize_t got = read(m_wakeFd, &count, sizeof(count));
+            (void)got;
+        }
+        m_sleeping.store(false, std::memory_order_relaxed);
+    }
+}
+
+TableShard::Table* TableShard::find(uint32_t id) {
+    if (id % m_shards != (uint32_t)m_index) {
+        return nullptr;
+    }
+    size_t local = id / m_shards;
+    return local < m_tables.size() ? m_tables[local].get() : nullptr;
+}
+
+void TableShard::execute(const ShardCommand& command) {
+    if (command.disconnect) {
+        for (auto& table : m_tables) {
+            if (table) {
+                subscribe(*table, command.connection, false);
+            }
+        }
+        return;
+    }
+
+    const Protocol::Request& request = command.request;
+    if (request.type == Protocol::CREATE_TABLE) {
+        std::unique_ptr<Table> table(new Table());
+        table->id = (uint32_t)(m_tables.size() * m_shards + m_index);
+        table->subscriberCount = 0;
+        table->engine.setStrategy(0, submittedRank);
+        table->engine.setStrategy(1, submittedRank);
+        table->engine.setSeed(request.seed);
+        table->engine.startNewGame();
+        m_tables.push_back(std::move(table));
+        m_tableCount.fetch_add(1, std::memory_order_relaxed);
+        reply(command.connection, request, Protocol::OK, m_tables.back().get());
+        return;
+    }
+
+    Table* table = find(request.table);
+    if (!table) {
+        reply(command.connection, request, Protocol::NO_TABLE, nullptr);
+        return;
+    }
+    switch (request.type) {
+        case Protocol::NEW_GAME:
+            table->engine.setSeed(request.seed);
+            table->engine.startNewGame();
+            reply(command.connection, request, Protocol::OK, table);
+            break;
+        case Protocol::MOVE: {
+            t_submittedRank = request.rank;
+            bool moved = table->engine.stepGame();
+            if (moved) {
+                m_moves.fetch_add(1, std::memory_order_relaxed);
+            }
+            reply(command.connection, request, moved ? Protocol::OK : Protocol::GAME_OVER, table);
+            break;
+        }
+        case Protocol::SUBSCRIBE:
+            if (table->subscriberCount == MAX_SUBSCRIBERS) {
+                reply(command.connection, request, Protocol::BUSY, table);
+                break;
+            }
+            subscribe(*table, command.connection, true);
+            reply(command.connection, request, Protocol::OK, table);
+            break;
+        case Protocol::UNSUBSCRIBE:
+            subscribe(*table, command.connection, false);
+            reply(command.connection, request, Protocol::OK, table);
+            break;
+        case Protocol::CLOSE_TABLE:
+            reply(command.connection, request, Protocol::OK, table);
+            m_tables[request.table / m_shards].reset();
+            m_tableCount.fetch_sub(1, std::memory_order_relaxed);
+            break;
+        default:
+            reply(command.connection, request, Protocol::BAD_REQUEST, table);
+            break;
+    }
+}
+
+// Adds or removes a subscriber; the engine only builds events while a
+// table has one
+void TableShard::subscribe(Table& table, uint32_t connection, bool add) {
+    int found = -1;
+    for (int i = 0; i < table.subscriberCount; ++i) {
+        if (table.subscribers[i] == connection) {
+            found = i;
+        }
+    }
+    if (add && found < 0) {
+        table.subscribers[table.subscriberCount++] = connection;
+    } else if (!add && found >= 0) {
+        table.subscribers[found] = table.subscribers[--table.subscriberCount];
+    }
+
+    if (table.subscriberCount == 0) {
+        table.engine.setEventCallback(nullptr);
+    } else if (add && table.subscriberCount == 1) {
+        Table* target = &table;
+        table.engine.setEventCallback([this, target](const GameEvent& event) {
+            Protocol::EventFrame frame;
+            frame.table = target->id;
+            frame.type = (uint8_t)event.type;
+            frame.player = (int8_t)playerIndex(event.player);
+            frame.opponent = (int8_t)playerIndex(event.opponent);
+            frame.rank = (uint8_t)event.rank;
+            frame.count = (uint8_t)event.count;
+            frame.cardRank = (uint8_t)event.drawnCard.rank;
+            frame.cardSuit = (uint8_t)event.drawnCard.suit;
+            uint8_t bytes[Protocol::MAX_FRAME];
+            int size = Protocol::encodeEvent(frame, bytes);
+            for (int i = 0; i < target->subscriberCount; ++i) {
+                send(target->subscribers[i], bytes, size);
+            }
+            m_events.fetch_add(1, std::memory_order_relaxed);
+        });
+    }
+}
+
+void TableShard::reply(uint32_t connection, const Protocol::Request& request,
+                       Protocol::Status status, const Table* table) {
+    Protocol::Reply reply = Protocol::Reply();
+    reply.tag = request.tag;
+    reply.table = table ? table->id : request.table;
+    reply.status = status;
+    if (table) {
+        reply.turn = table->engine.getCurrentTurn() == "AI2" ? 1 : 0;
+        reply.books1 = (uint8_t)table->engine.getBooks1();
+        reply.books2 = (uint8_t)table->engine.getBooks2();
+    }
+    uint8_t bytes[Protocol::MAX_FRAME];
+    send(connection, bytes, Protocol::encodeReply(reply, bytes));
+}
+
+void TableShard::send(uint32_t connection, const uint8_t* bytes, int size) {
+    ShardOutput output;
+    output.connection = connection;
+    output.size = (uint8_t)size;
+    std::copy(bytes, bytes + size, output.bytes);
+    while (!m_output.push(output)) {
+        // The I/O thread drains output whatever else it is doing
+        notifyIo();
+        std::this_thread::yield();
+    }
+}
+
+void TableShard::notifyIo() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!m_outputPending.exchange(true)) {
+        signalFd(m_ioWakeFd);
+    }
+}
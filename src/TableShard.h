@@ -0,0 +1,93 @@
+#ifndef TABLESHARD_H
+#define TABLESHARD_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "GameEngine.h"
+#include "Protocol.h"
+#include "SpscRing.h"
+
+// A request routed to the shard owning its table. disconnect drops every
+// subscription of the connection instead.
+struct ShardCommand {
+    uint32_t connection;
+    bool disconnect;
+    Protocol::Request request;
+};
+
+// One encoded reply or event frame for a connection
+struct ShardOutput {
+    uint32_t connection;
+    uint8_t size;
+    uint8_t bytes[Protocol::MAX_FRAME];
+};
+
+// A worker thread owning a share of the server's tables. Table ids encode
+// the shard (id % shards), so no table is ever touched by two threads and
+// the tables need no locks. Commands come from the server's I/O thread and
+// frames go back to it through a pair of single-producer rings; each side
+// sleeps on an eventfd and is only woken when the other finds it asleep or
+// has nothing pending, so a busy shard makes no system calls per request.
+class TableShard {
+public:
+    static const int MAX_SUBSCRIBERS = 4; // Per table
+
+    // ioWakeFd: eventfd the I/O thread polls, written when output is ready
+    TableShard(int index, int shards, int ioWakeFd);
+    ~TableShard();
+
+    // The rings are cache-line aligned, which plain new does not honor before C++17
+    static void* operator new(size_t size);
+    static void operator delete(void* pointer);
+
+    void start();
+    void stop();
+
+    // I/O thread side. post() is false when the ring is full; wake() after
+    // a batch of posts; clearPending() before draining output with take()
+    bool post(const ShardCommand& command) { return m_commands.push(command); }
+    void wake();
+    void clearPending() { m_outputPending.store(false, std::memory_order_seq_cst); }
+    bool take(ShardOutput& output) { return m_output.pop(output); }
+
+    uint64_t tables() const { return m_tableCount.load(std::memory_order_relaxed); }
+    uint64_t moves() const { return m_moves.load(std::memory_order_relaxed); }
+    uint64_t events() const { return m_events.load(std::memory_order_relaxed); }
+
+private:
+    struct Table {
+        GameEngine engine;
+        uint32_t id;
+        uint32_t subscribers[MAX_SUBSCRIBERS]; // Connection ids
+        int subscriberCount;
+    };
+
+    int m_index;
+    int m_shards;
+    int m_wakeFd;
+    int m_ioWakeFd;
+    std::vector<std::unique_ptr<Table>> m_tables; // By id / shards; null once closed
+    SpscRing<ShardCommand, 4096> m_commands;
+    SpscRing<ShardOutput, 16384> m_output;
+    std::atomic<bool> m_sleeping;
+    std::atomic<bool> m_outputPending;
+    std::atomic<bool> m_running;
+    std::atomic<uint64_t> m_tableCount;
+    std::atomic<uint64_t> m_moves;
+    std::atomic<uint64_t> m_events;
+    std::thread m_thread;
+
+    void run();
+    void execute(const ShardCommand& command);
+    Table* find(uint32_t id);
+    void subscribe(Table& table, uint32_t connection, bool add);
+    void reply(uint32_t connection, const Protocol::Request& request, Protocol::Status status,
+               const Table* table);
+    void send(uint32_t connection, const uint8_t* bytes, int size);
+    void notifyIo();
+};
+
+#endif // TABLESHARD_H
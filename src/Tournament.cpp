@@ -0,0 +1,286 @@
+#include "Tournament.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "GameEngine.h"
+
+namespace {
+
+const double Z_95 = 1.959964;   // Two-sided 95% normal quantile
+const double MIN_VARIANCE = 1e-9; // Keeps the test defined when every deal scores the same
+const int RATING_ITERATIONS = 500;
+
+const char* verdictName(Verdict verdict) {
+    switch (verdict) {
+        case Verdict::RUNNING:       return "running";
+        case Verdict::FIRST_BETTER:  return "first better";
+        case Verdict::SECOND_BETTER: return "second better";
+        case Verdict::EQUAL:         return "equal";
+        case Verdict::INCONCLUSIVE:  return "inconclusive";
+    }
+    return "unknown";
+}
+
+double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Points for player 0 (AI1): 1 for a win, 0.5 for a tie
+double playDeal(QuietGameEngine& engine, unsigned int seed, RankChooser first,
+                RankChooser second) {
+    engine.setStrategy(0, first);
+    engine.setStrategy(1, second);
+    engine.setSeed(seed);
+    engine.startNewGame();
+    while (engine.stepGame()) {
+    }
+    int books1 = engine.getBooks1();
+    int books2 = engine.getBooks2();
+    return books1 > books2 ? 1.0 : books1 == books2 ? 0.5 : 0.0;
+}
+
+void countGame(PairingResult& result, double points) {
+    if (points == 1.0) {
+        ++result.wins;
+    } else if (points == 0.5) {
+        ++result.ties;
+    } else {
+        ++result.losses;
+    }
+}
+
+} // namespace
+
+double PairingResult::score() const {
+    return deals > 0 ? scoreSum / deals : 0.5;
+}
+
+void PairingResult::interval(double& low, double& high) const {
+    double mean = score();
+    double variance = deals > 0 ? std::max(0.0, scoreSqSum / deals - mean * mean) : 0.0;
+    double margin = deals > 1 ? Z_95 * std::sqrt(variance / deals) : 0.5;
+    low = std::max(0.0, mean - margin);
+    high = std::min(1.0, mean + margin);
+}
+
+double eloFromScore(double score) {
+    score = std::min(std::max(score, 0.001), 0.999);
+    return 400.0 * std::log10(score / (1.0 - score));
+}
+
+Tournament::Tournament(const std::vector<const Strategy*>& strategies,
+                       const TournamentOptions& options)
+    : m_strategies(strategies), m_options(options) {
+    m_options.threads = std::max(1, m_options.threads);
+    m_options.chunkDeals = std::max(1, m_options.chunkDeals);
+    for (int a = 0; a < (int)m_strategies.size(); ++a) {
+        for (int b = a + 1; b < (int)m_strategies.size(); ++b) {
+            PairingResult result = PairingResult();
+            result.first = a;
+            result.second = b;
+            result.verdict = Verdict::RUNNING;
+            m_results.push_back(result);
+        }
+    }
+}
+
+void Tournament::merge(PairingResult& result, const PairingResult& chunk) const {
+    result.deals += chunk.deals;
+    result.wins += chunk.wins;
+    result.ties += chunk.ties;
+    result.losses += chunk.losses;
+    result.scoreSum += chunk.scoreSum;
+    result.scoreSqSum += chunk.scoreSqSum;
+}
+
+// Generalized SPRT on per-deal scores: the log-likelihood ratio of a score
+// of s1 = scoreFromElo(elo1) against 0.5, from the sample mean and variance
+void Tournament::test(PairingResult& result) const {
+    if (result.deals < 2) {
+        return;
+    }
+    double n = result.deals;
+    double mean = result.scoreSum / n;
+    double variance = std::max(MIN_VARIANCE, result.scoreSqSum / n - mean * mean);
+    double s0 = 0.5;
+    double s1 = scoreFromElo(m_options.elo1);
+    result.llr[0] = n * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+    result.llr[1] = n * (s1 - s0) * (2.0 * (1.0 - mean) - s0 - s1) / (2.0 * variance);
+
+    double lower = std::log(m_options.beta / (1.0 - m_options.alpha));
+    double upper = std::log((1.0 - m_options.beta) / m_options.alpha);
+    if (result.llr[0] >= upper) {
+        result.verdict = Verdict::FIRST_BETTER;
+    } else if (result.llr[1] >= upper) {
+        result.verdict = Verdict::SECOND_BETTER;
+    } else if (result.llr[0] <= lower && result.llr[1] <= lower) {
+        result.verdict = Verdict::EQUAL;
+    } else if (result.deals >= m_options.maxDeals) {
+        result.verdict = Verdict::INCONCLUSIVE;
+    }
+}
+
+void Tournament::run() {
+    // Per pairing: chunks handed out, chunks merged, and finished chunks
+    // waiting for an earlier one
+    struct Schedule {
+        int nextChunk = 0;
+        int merged = 0;
+        std::map<int, PairingResult> pending;
+    };
+    std::vector<Schedule> schedules(m_results.size());
+    int chunkDeals = m_options.chunkDeals;
+    int chunks = (m_options.maxDeals + chunkDeals - 1) / chunkDeals;
+    std::mutex mutex;
+
+    auto worker = [&]() {
+        QuietGameEngine engine;
+        for (;;) {
+            int pairing = -1;
+            int chunk = 0;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (size_t i = 0; i < m_results.size(); ++i) {
+                    if (m_results[i].verdict == Verdict::RUNNING && schedules[i].nextChunk < chunks &&
+                        (pairing < 0 || schedules[i].nextChunk < schedules[pairing].nextChunk)) {
+                        pairing = (int)i;
+                    }
+                }
+                if (pairing < 0) {
+                    return;
+                }
+                chunk = schedules[pairing].nextChunk++;
+            }
+
+            const PairingResult& current = m_results[pairing];
+            RankChooser first = m_strategies[current.first]->choose;
+            RankChooser second = m_strategies[current.second]->choose;
+            PairingResult partial = PairingResult();
+            int begin = chunk * chunkDeals;
+            int end = std::min(begin + chunkDeals, m_options.maxDeals);
+            for (int d = begin; d < end; ++d) {
+                unsigned int seed = m_options.seed + (unsigned int)d;
+                double seated = playDeal(engine, seed, first, second);
+                double swapped = 1.0 - playDeal(engine, seed, second, first);
+                countGame(partial, seated);
+                countGame(partial, swapped);
+                double score = (seated + swapped) / 2.0;
+                partial.scoreSum += score;
+                partial.scoreSqSum += score * score;
+                ++partial.deals;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            Schedule& schedule = schedules[pairing];
+            PairingResult& result = m_results[pairing];
+            schedule.pending[chunk] = partial;
+            while (result.verdict == Verdict::RUNNING && schedule.pending.count(schedule.merged)) {
+                merge(result, schedule.pending[schedule.merged]);
+                schedule.pending.erase(schedule.merged++);
+                test(result);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 1; t < m_options.threads; ++t) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (PairingResult& result : m_results) {
+        if (result.verdict == Verdict::RUNNING) {
+            result.verdict = Verdict::INCONCLUSIVE;
+        }
+    }
+}
+
+std::vector<double> Tournament::eloRatings() const {
+    // Minorization-maximization for Bradley-Terry strengths; every pairing
+    // also counts one virtual tied game so no strength runs off to 0 or infinity
+    size_t count = m_strategies.size();
+    std::vector<double> points(count, 0.0);
+    std::vector<double> games(count * count, 0.0); // games[i * count + j]: i against j
+    for (const PairingResult& result : m_results) {
+        int played = 2 * result.deals + 1;
+        double firstPoints = result.wins + 0.5 * result.ties + 0.5;
+        points[result.first] += firstPoints;
+        points[result.second] += played - firstPoints;
+        games[result.first * count + result.second] += played;
+        games[result.second * count + result.first] += played;
+    }
+
+    std::vector<double> strength(count, 1.0);
+    for (int iteration = 0; iteration < RATING_ITERATIONS; ++iteration) {
+        double logSum = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            double denominator = 0.0;
+            for (size_t j = 0; j < count; ++j) {
+                if (j != i && games[i * count + j] > 0) {
+                    denominator += games[i * count + j] / (strength[i] + strength[j]);
+                }
+            }
+            if (denominator > 0) {
+                strength[i] = points[i] / denominator;
+            }
+            logSum += std::log(strength[i]);
+        }
+        double scale = std::exp(logSum / count);
+        for (double& s : strength) {
+            s /= scale;
+        }
+    }
+
+    std::vector<double> ratings(count);
+    for (size_t i = 0; i < count; ++i) {
+        ratings[i] = 400.0 * std::log10(strength[i]);
+    }
+    return ratings;
+}
+
+uint64_t Tournament::gamesPlayed() const {
+    uint64_t games = 0;
+    for (const PairingResult& result : m_results) {
+        games += 2 * (uint64_t)result.deals;
+    }
+    return games;
+}
+
+void Tournament::report(std::ostream& out) const {
+    char line[160];
+    snprintf(line, sizeof(line), "%-20s %6s %17s %6s %13s %21s  %s\n", "pairing", "deals",
+             "games W-T-L", "score", "95% CI", "Elo (95% CI)", "verdict");
+    out << line;
+    for (const PairingResult& result : m_results) {
+        std::string name = std::string(m_strategies[result.first]->name) + " vs " +
+                           m_strategies[result.second]->name;
+        double low, high;
+        result.interval(low, high);
+        char games[32];
+        snprintf(games, sizeof(games), "%d-%d-%d", result.wins, result.ties, result.losses);
+        snprintf(line, sizeof(line), "%-20s %6d %17s %5.1f%% %5.1f-%5.1f%% %+7.1f (%+6.0f,%+6.0f)  %s\n",
+                 name.c_str(), result.deals, games, 100.0 * result.score(), 100.0 * low,
+                 100.0 * high, eloFromScore(result.score()), eloFromScore(low),
+                 eloFromScore(high), verdictName(result.verdict));
+        out << line;
+    }
+
+    std::vector<double> ratings = eloRatings();
+    std::vector<size_t> order(ratings.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&ratings](size_t a, size_t b) { return ratings[a] > ratings[b]; });
+    out << "Elo ratings (mean 0):\n";
+    for (size_t i : order) {
+        snprintf(line, sizeof(line), "  %-10s %+7.1f\n", m_strategies[i]->name, ratings[i]);
+        out << line;
+    }
+}
@@ -0,0 +1,78 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "Strategy.h"
+
+struct TournamentOptions {
+    int threads = 1;
+    int maxDeals = 20000;   // Per pairing; each deal is played twice
+    int chunkDeals = 50;    // Deals per work item
+    unsigned int seed = 1;  // Deal d of every pairing uses seed + d
+    double elo1 = 20.0;     // Difference the test should detect
+    double alpha = 0.05;    // Chance of calling equal strategies different
+    double beta = 0.05;     // Chance of missing an elo1 difference
+};
+
+enum class Verdict {
+    RUNNING,
+    FIRST_BETTER,  // By at least elo1, with the requested confidence
+    SECOND_BETTER,
+    EQUAL,         // Within elo1 of each other
+    INCONCLUSIVE   // maxDeals played without a decision
+};
+
+// Outcome of one pairing from the first strategy's side
+struct PairingResult {
+    int first;  // Indices into the tournament's strategies
+    int second;
+    int deals;
+    int wins;   // Games; each deal is played with seats both ways
+    int ties;
+    int losses;
+    double scoreSum;   // Per-deal score: points over the two games / 2
+    double scoreSqSum;
+    double llr[2];     // Log-likelihood ratios for "first better", "second better"
+    Verdict verdict;
+
+    double score() const;                       // Mean per-deal score
+    void interval(double& low, double& high) const; // 95% confidence
+};
+
+// Elo difference for an expected score, clamped away from 0 and 1
+double eloFromScore(double score);
+
+// Plays every pairing of the given strategies in duplicate format: each
+// seeded deal is played twice with the seats swapped, so the luck of the
+// deal cancels out within the deal's score and far fewer games are needed.
+// Work items are chunks of deals, handed out across a pool of threads to
+// whichever undecided pairing has the fewest deals scheduled. Finished
+// chunks are merged in deal order, and after each merge a sequential
+// probability ratio test (the normal approximation of the generalized
+// SPRT, for +elo1 against 0 in both directions) decides whether the
+// pairing can stop. Results do not depend on the thread count.
+class Tournament {
+public:
+    Tournament(const std::vector<const Strategy*>& strategies, const TournamentOptions& options);
+
+    void run();
+
+    const std::vector<PairingResult>& results() const { return m_results; }
+    // Bradley-Terry ratings from all games, mean zero
+    std::vector<double> eloRatings() const;
+    uint64_t gamesPlayed() const;
+
+    void report(std::ostream& out) const;
+
+private:
+    std::vector<const Strategy*> m_strategies;
+    TournamentOptions m_options;
+    std::vector<PairingResult> m_results;
+
+    void merge(PairingResult& result, const PairingResult& chunk) const;
+    void test(PairingResult& result) const;
+};
+
+#endif // TOURNAMENT_H
@@ -0,0 +1,173 @@
+#include "Tracer.h"
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Events each thread can record; later ones are counted and dropped, except
+// that a span's end always has a slot kept for it once its begin is stored
+const size_t TRACE_BUFFER_EVENTS = 1 << 18;
+
+namespace {
+
+struct TraceRecord {
+    const char* name;
+    const char* category;
+    uint64_t timestamp; // monotonicNs
+    int64_t arg;
+    char phase;         // 'B', 'E' or 'i'
+};
+
+// Filled by its owning thread only. count is published with release
+// ordering so the writer may read the prefix at any time; name may be set
+// while the writer runs, so it is atomic too.
+struct ThreadBuffer {
+    int tid;
+    std::atomic<const char*> name;
+    std::unique_ptr<TraceRecord[]> records;
+    std::atomic<size_t> count;
+    uint64_t dropped;
+    size_t open;    // Spans stored whose end is still to come
+    size_t skipped; // Innermost open spans whose begin was dropped
+
+    explicit ThreadBuffer(int id)
+        : tid(id), name(nullptr), records(new TraceRecord[TRACE_BUFFER_EVENTS]),
+          count(0), dropped(0), open(0), skipped(0) {}
+};
+
+std::mutex g_buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>>& buffers() {
+    static std::vector<std::unique_ptr<ThreadBuffer>> all;
+    return all;
+}
+
+ThreadBuffer& localBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(g_buffersMutex);
+        buffers().emplace_back(new ThreadBuffer((int)buffers().size() + 1));
+        buffer = buffers().back().get();
+    }
+    return *buffer;
+}
+
+void record(char phase, const char* name, const char* category, int64_t arg) {
+    ThreadBuffer& buffer = localBuffer();
+    size_t index = buffer.count.load(std::memory_order_relaxed);
+
+    // Spans nest, and free slots only shrink, so once a begin is dropped
+    // every span opened inside it is dropped too: an end belongs to a
+    // dropped begin exactly while skipped is non-zero.
+    bool fits;
+    if (phase == 'E' && buffer.skipped > 0) {
+        --buffer.skipped;
+        fits = false;
+    } else if (phase == 'E') {
+        fits = index < TRACE_BUFFER_EVENTS;
+        if (buffer.open > 0) {
+            --buffer.open;
+        }
+    } else {
+        size_t reserve = buffer.open + (phase == 'B' ? 1 : 0);
+        fits = index + reserve < TRACE_BUFFER_EVENTS;
+        if (phase == 'B' && fits) {
+            ++buffer.open;
+        } else if (phase == 'B') {
+            ++buffer.skipped;
+        }
+    }
+    if (!fits) {
+        ++buffer.dropped;
+        return;
+    }
+    buffer.records[index] = TraceRecord{name, category, monotonicNs(), arg, phase};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+} // namespace
+
+namespace Tracer {
+
+std::atomic<bool> g_enabled(false);
+
+void start() {
+    g_enabled.store(true, std::memory_order_relaxed);
+}
+
+void setThreadName(const char* name) {
+    if (enabled()) {
+        localBuffer().name.store(name, std::memory_order_release);
+    }
+}
+
+void begin(const char* name, const char* category) {
+    record('B', name, category, 0);
+}
+
+void end(const char* name, const char* category) {
+    record('E', name, category, 0);
+}
+
+void instant(const char* name, const char* category, int64_t arg) {
+    record('i', name, category, arg);
+}
+
+bool write(const std::string& path) {
+    g_enabled.store(false, std::memory_order_relaxed);
+
+    FILE* f = fopen(path.c_str(), "w");
+    if (!f) {
+        std::cerr << "Cannot write trace to " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(g_buffersMutex);
+    uint64_t origin = UINT64_MAX;
+    for (const auto& buffer : buffers()) {
+        if (buffer->count.load(std::memory_order_acquire) > 0) {
+            origin = std::min(origin, buffer->records[0].timestamp);
+        }
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+    size_t total = 0;
+    uint64_t dropped = 0;
+    for (const auto& buffer : buffers()) {
+        size_t count = buffer->count.load(std::memory_order_acquire);
+        dropped += buffer->dropped;
+        const char* name = buffer->name.load(std::memory_order_acquire);
+        if (name) {
+            fprintf(f, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,"
+                       "\"args\":{\"name\":\"%s\"}}",
+                    first ? "" : ",\n", buffer->tid, name);
+            first = false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            const TraceRecord& r = buffer->records[i];
+            fprintf(f, "%s{\"ph\":\"%c\",\"name\":\"%s\",\"cat\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+                    first ? "" : ",\n", r.phase, r.name, r.category,
+                    (r.timestamp - origin) / 1000.0, buffer->tid);
+            if (r.phase == 'i') {
+                fprintf(f, ",\"s\":\"t\",\"args\":{\"value\":%lld}", (long long)r.arg);
+            }
+            fputc('}', f);
+            first = false;
+        }
+        total += count;
+    }
+    fprintf(f, "\n]}\n");
+    bool ok = fclose(f) == 0;
+
+    std::cout << "Wrote " << total << " trace events to " << path;
+    if (dropped > 0) {
+        std::cout << " (" << dropped << " dropped: per-thread buffer full)";
+    }
+    std::cout << std::endl;
+    return ok;
+}
+
+} // namespace Tracer
@@ -0,0 +1,63 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Optional timeline recorder writing Chrome trace-event JSON (open it in
+// Perfetto or chrome://tracing). Every thread records into its own
+// fixed-size buffer without locks; while tracing is off each TRACE_* site
+// costs one relaxed load and a branch.
+//
+// Names and categories are stored by pointer and must be string literals
+// (or otherwise outlive the trace).
+
+namespace Tracer {
+
+extern std::atomic<bool> g_enabled;
+
+inline bool enabled() { return g_enabled.load(std::memory_order_relaxed); }
+
+void start();
+
+// Stop recording and write everything recorded so far. Threads still
+// running may lose their last few events; stop them first for a clean end.
+bool write(const std::string& path);
+
+// Label the calling thread in the viewer (only while tracing)
+void setThreadName(const char* name);
+
+void begin(const char* name, const char* category);
+void end(const char* name, const char* category);
+void instant(const char* name, const char* category, int64_t arg = 0);
+
+} // namespace Tracer
+
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category)
+        : m_name(name), m_category(category), m_active(Tracer::enabled()) {
+        if (m_active) {
+            Tracer::begin(m_name, m_category);
+        }
+    }
+    ~TraceSpan() {
+        if (m_active) {
+            Tracer::end(m_name, m_category);
+        }
+    }
+
+private:
+    const char* m_name;
+    const char* m_category;
+    bool m_active; // Spans opened before a start() are not closed after it
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SPAN(name, category) TraceSpan TRACE_CONCAT(traceSpan, __LINE__)(name, category)
+#define TRACE_INSTANT(name, category, arg) \
+    do { if (Tracer::enabled()) Tracer::instant(name, category, arg); } while (0)
+
+#endif // TRACER_H
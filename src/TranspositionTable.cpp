@@ -0,0 +1,149 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+
+namespace {
+
+const size_t CACHE_LINE = 64;
+const int GENERATIONS = 64;          // 6-bit generation counter
+const size_t OCCUPANCY_SAMPLE = 4096; // Buckets looked at by occupancy()
+
+uint64_t mix(uint64_t x) {
+    x *= 0x9e3779b97f4a7c15ull;
+    return x ^ (x >> 29);
+}
+
+// Data word: hi 32 bits of the position, then generation (6 bits), bound
+// (2), depth (8) and score (16)
+uint64_t encodeData(const PackedPosition& position, int score, int depth, Bound bound,
+                    uint32_t generation) {
+    uint32_t low = (uint32_t)(uint16_t)score | (uint32_t)(depth & 0xff) << 16 |
+                   (uint32_t)bound << 24 | (generation % GENERATIONS) << 26;
+    return position.hi << 32 | low;
+}
+
+Bound boundOf(uint64_t data) {
+    return (Bound)((data >> 24) & 3);
+}
+
+int depthOf(uint64_t data) {
+    return (int)((data >> 16) & 0xff);
+}
+
+uint32_t generationOf(uint64_t data) {
+    return (uint32_t)(data >> 26) & (GENERATIONS - 1);
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t megabytes)
+    : m_generation(0), m_probes(0), m_hits(0), m_stores(0), m_replacements(0) {
+    size_t wanted = std::max<size_t>(1, megabytes * 1024 * 1024 / sizeof(Bucket));
+    size_t count = 1;
+    while (count * 2 <= wanted) {
+        count <<= 1;
+    }
+    m_storage.reset(new Bucket[count + 1]);
+    uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.get());
+    address = (address + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+    m_buckets = reinterpret_cast<Bucket*>(address);
+    m_mask = count - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t i = 0; i <= m_mask; ++i) {
+        for (Entry& entry : m_buckets[i].entries) {
+            entry.key.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    m_generation.store(0, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::probe(const PackedPosition& position, uint64_t hash,
+                               TTData& data) const {
+    m_probes.fetch_add(1, std::memory_order_relaxed);
+    const Bucket& bucket = bucketFor(hash);
+    for (const Entry& entry : bucket.entries) {
+        uint64_t word = entry.data.load(std::memory_order_relaxed);
+        uint64_t key = entry.key.load(std::memory_order_relaxed);
+        if ((word >> 32) == position.hi && (key ^ mix(word)) == position.lo &&
+            boundOf(word) != Bound::NONE) {
+            data.score = (int16_t)(word & 0xffff);
+            data.depth = (uint8_t)depthOf(word);
+            data.bound = boundOf(word);
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(const PackedPosition& position, uint64_t hash, int score,
+                               int depth, Bound bound) {
+    uint32_t generation = m_generation.load(std::memory_order_relaxed) % GENERATIONS;
+    Bucket& bucket = bucketFor(hash);
+
+    // Same position first, then an empty entry, then the cheapest victim:
+    // older searches go before the current one, shallow before deep
+    Entry* target = nullptr;
+    int worst = 0;
+    bool replacing = false;
+    for (Entry& entry : bucket.entries) {
+        uint64_t word = entry.data.load(std::memory_order_relaxed);
+        uint64_t key = entry.key.load(std::memory_order_relaxed);
+        if (boundOf(word) == Bound::NONE) {
+            if (!target || replacing) {
+                target = &entry;
+                replacing = false;
+                worst = -1;
+            }
+            continue;
+        }
+        if ((word >> 32) == position.hi && (key ^ mix(word)) == position.lo) {
+            if (depth < depthOf(word) && generationOf(word) == generation) {
+                return; // Keep the deeper result from this search
+            }
+            target = &entry;
+            replacing = false;
+            break;
+        }
+        int age = (int)((generation - generationOf(word)) % GENERATIONS);
+        int value = age * 256 - depthOf(word); // Higher is a better victim
+        if (!target || (replacing && value > worst)) {
+            target = &entry;
+            worst = value;
+            replacing = true;
+        }
+    }
+
+    uint64_t word = encodeData(position, score, depth, bound, generation);
+    target->key.store(position.lo ^ mix(word), std::memory_order_relaxed);
+    target->data.store(word, std::memory_order_relaxed);
+    m_stores.fetch_add(1, std::memory_order_relaxed);
+    if (replacing) {
+        m_replacements.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void TranspositionTable::newSearch() {
+    m_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+double TranspositionTable::occupancy() const {
+    size_t sample = std::min(OCCUPANCY_SAMPLE, buckets());
+    size_t used = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        for (const Entry& entry : m_buckets[i].entries) {
+            if (boundOf(entry.data.load(std::memory_order_relaxed)) != Bound::NONE) {
+                ++used;
+            }
+        }
+    }
+    return (double)used / (sample * BUCKET_ENTRIES);
+}
+
+double TranspositionTable::hitRate() const {
+    uint64_t total = probes();
+    return total > 0 ? (double)hits() / total : 0.0;
+}
@@ -0,0 +1,74 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "Position.h"
+
+enum class Bound : uint8_t {
+    NONE,  // Empty entry
+    EXACT,
+    LOWER, // Score is at least this
+    UPPER  // Score is at most this
+};
+
+struct TTData {
+    int16_t score;
+    uint8_t depth;
+    Bound bound;
+};
+
+// Fixed-size position table shared by search threads without locks, in
+// 64-byte buckets of four 16-byte entries. An entry holds the 96 used bits
+// of its PackedPosition and 32 bits of data in two words, the first XORed
+// with a mix of the second: a probe compares whole positions, so hash
+// collisions never match, and an entry torn by two racing writers decodes
+// to a position nobody asked for. Stores replace the same position, an
+// empty entry, or else the shallowest entry left by an older search.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(size_t megabytes);
+
+    // hash is Zobrist::hash(position), e.g. the engine's positionHash()
+    bool probe(const PackedPosition& position, uint64_t hash, TTData& data) const;
+    void store(const PackedPosition& position, uint64_t hash, int score, int depth, Bound bound);
+
+    void newSearch(); // Ages every entry stored so far
+    void clear();     // Not thread-safe
+
+    size_t buckets() const { return m_mask + 1; }
+    size_t memoryBytes() const { return buckets() * sizeof(Bucket); }
+    double occupancy() const; // Share of used entries, from a sample
+    uint64_t probes() const { return m_probes.load(std::memory_order_relaxed); }
+    uint64_t hits() const { return m_hits.load(std::memory_order_relaxed); }
+    uint64_t stores() const { return m_stores.load(std::memory_order_relaxed); }
+    uint64_t replacements() const { return m_replacements.load(std::memory_order_relaxed); }
+    double hitRate() const;
+
+private:
+    static const int BUCKET_ENTRIES = 4;
+
+    struct Entry {
+        std::atomic<uint64_t> key;  // position.lo ^ mix(data)
+        std::atomic<uint64_t> data; // position.hi << 32 | generation, bound, depth, score
+    };
+
+    struct Bucket {
+        Entry entries[BUCKET_ENTRIES];
+    };
+
+    Bucket& bucketFor(uint64_t hash) const { return m_buckets[hash & m_mask]; }
+
+    std::unique_ptr<Bucket[]> m_storage; // One spare bucket for alignment
+    Bucket* m_buckets;                   // Cache-line aligned
+    size_t m_mask;
+    std::atomic<uint32_t> m_generation;
+    mutable std::atomic<uint64_t> m_probes;
+    mutable std::atomic<uint64_t> m_hits;
+    std::atomic<uint64_t> m_stores;
+    std::atomic<uint64_t> m_replacements;
+};
+
+#endif // TRANSPOSITIONTABLE_H
@@ -1,8 +1,18 @@
 #include "UIManager.h"
+#include "X11RenderTarget.h"
+#include "ImageRenderTarget.h"
+#include "TableGrid.h"
+#include "GameLog.h"
+#include "AudioManager.h"
+#include "Replay.h"
+#include "Profiler.h"
+#include "Tracer.h"
 #include <cstring>
+#include <cstdio>
 #include <cmath>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 
 // Constants
 const int CARD_WIDTH = 80;
@@ -11,12 +21,58 @@ const int CARD_SPACING = 10;
 const int BUTTON_WIDTH = 200;
 const int BUTTON_HEIGHT = 50;
 
+// Playback speeds selectable with +/-; index 2 is real time (1x)
+const float PLAYBACK_SPEEDS[] = {0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f,
+                                 32.0f, 64.0f, 128.0f, 256.0f, 512.0f, 1024.0f};
+const int NUM_PLAYBACK_SPEEDS = sizeof(PLAYBACK_SPEEDS) / sizeof(PLAYBACK_SPEEDS[0]);
+const int DEFAULT_SPEED_INDEX = 2;
+
+// Upper bound on engine steps per frame so a backlog can never stall the UI
+const int MAX_STEPS_PER_FRAME = 256;
+
+// Animations shorter than this (in wall-clock seconds) would not be seen
+const float MIN_VISIBLE_ANIMATION = 1.0f / 30.0f;
+
+// Safety limit for jump-to-end in case the engine never reports game over
+const int MAX_STEPS_PER_GAME = 10000;
+
+// Game log panel geometry
+const int LOG_PANEL_WIDTH = 420;
+const int LOG_ROW_HEIGHT = 16;
+
+// Replay timeline, as wide as the log panel; clicks this close count
+const int TIMELINE_HEIGHT = 10;
+const int TIMELINE_SLACK = 6;
+
+// Height of the status strip above the table grid
+const int GRID_STATUS_HEIGHT = 24;
+
+// Events timed per frame for the latency overlay; a larger burst is sampled
+const size_t MAX_UNPRESENTED_EVENTS = 256;
+
+// Performance HUD: frames in the graph (2 px each), the frame time at the
+// top of the graph, and how often steps/s is recomputed
+const int HUD_HISTORY = 120;
+const float HUD_GRAPH_MS = 16.7f;
+const float HUD_RATE_INTERVAL = 0.5f;
+
+// Card tween timing in game seconds (scaled by the playback speed)
+const float TWEEN_DURATION = 0.5f;
+const float TWEEN_STAGGER = 0.08f;
+
 UIManager::UIManager() 
-    : m_display(nullptr), m_window(0), m_gc(0), m_screen(0),
+    : m_display(nullptr), m_window(0), m_gc(0), m_screen(0), m_image(nullptr),
       m_width(1024), m_height(768), m_running(false),
       m_state(UIState::WELCOME), m_gameEngine(nullptr),
-      m_maxLogLines(6), m_mouseX(0), m_mouseY(0),
-      m_turnDelay(2.0f), m_turnTimer(0.0f) {
+      m_gameLog(new GameLog()), m_maxLogLines(6), m_logScroll(0), m_mouseX(0), m_mouseY(0),
+      m_turnDelay(2.0f), m_turnTimer(0.0f),
+      m_speedIndex(DEFAULT_SPEED_INDEX), m_paused(false), m_needsRedraw(true),
+      m_fullRedraw(true), m_replayPosition(0), m_replayLogged(-1), m_scrubbing(false),
+      m_showLatency(false), m_audio(nullptr),
+      m_showHud(false), m_frameHistory(HUD_HISTORY, 0.0f), m_frameHistoryPos(0),
+      m_hudMs(0.0), m_stepsTaken(0), m_stepsAtSample(0), m_stepsPerSecond(0.0),
+      m_stepSampleTime(0.0f) {
+    m_unpresentedEvents.reserve(MAX_UNPRESENTED_EVENTS);
 }
 
 UIManager::~UIManager() {
@@ -35,30 +91,27 @@ bool UIManager::initialize(int width, int height) {
     }
     
     m_screen = DefaultScreen(m_display);
-    m_blackPixel = BlackPixel(m_display, m_screen);
-    m_whitePixel = WhitePixel(m_display, m_screen);
-    
-    // Allocate colors
-    m_greenPixel = allocateColor(11, 93, 30);  // Dark green for table
-    m_redPixel = allocateColor(220, 20, 60);   // Red for hearts/diamonds
-    m_bluePixel = allocateColor(70, 130, 180); // Blue for card backs
     
     // Create window
     m_window = XCreateSimpleWindow(m_display, RootWindow(m_display, m_screen),
                                    100, 100, m_width, m_height, 1,
-                                   m_blackPixel, m_greenPixel);
+                                   BlackPixel(m_display, m_screen),
+                                   BlackPixel(m_display, m_screen));
     
     // Set window properties
     XStoreName(m_display, m_window, "Go Fish - AI vs AI");
     
     // Select input events
     XSelectInput(m_display, m_window, ExposureMask | KeyPressMask | 
-                 ButtonPressMask | PointerMotionMask | StructureNotifyMask);
+                 ButtonPressMask | ButtonReleaseMask | PointerMotionMask | StructureNotifyMask);
     
-    // Create graphics context
+    // Create graphics context and allocate colors
     m_gc = XCreateGC(m_display, m_window, 0, nullptr);
+    m_target.reset(new X11RenderTarget(m_display, m_screen, m_window, m_gc));
+    allocateColors();
     XSetForeground(m_display, m_gc, m_whitePixel);
     XSetBackground(m_display, m_gc, m_greenPixel);
+    XSetWindowBackground(m_display, m_window, m_greenPixel);
     
     // Map window
     XMapWindow(m_display, m_window);
@@ -68,7 +121,31 @@ bool UIManager::initialize(int width, int height) {
     return true;
 }
 
+bool UIManager::initializeHeadless(int width, int height) {
+    m_width = width;
+    m_height = height;
+    
+    m_image = new ImageRenderTarget(width, height);
+    m_target.reset(m_image);
+    allocateColors();
+    
+    m_running = true;
+    return true;
+}
+
+void UIManager::allocateColors() {
+    m_blackPixel = m_target->blackPixel();
+    m_whitePixel = m_target->whitePixel();
+    m_greenPixel = allocateColor(11, 93, 30);  // Dark green for table
+    m_redPixel = allocateColor(220, 20, 60);   // Red for hearts/diamonds
+    m_bluePixel = allocateColor(70, 130, 180); // Blue for card backs
+    m_buttonPixel = allocateColor(50, 100, 50);
+    m_buttonHoverPixel = allocateColor(100, 150, 100);
+}
+
 void UIManager::cleanup() {
+    m_target.reset();
+    m_image = nullptr;
     if (m_display) {
         if (m_gc) {
             XFreeGC(m_display, m_gc);
@@ -82,21 +159,26 @@ void UIManager::cleanup() {
 }
 
 unsigned long UIManager::allocateColor(int r, int g, int b) {
-    XColor color;
-    Colormap colormap = DefaultColormap(m_display, m_screen);
-    
-    color.red = r * 257;
-    color.green = g * 257;
-    color.blue = b * 257;
-    color.flags = DoRed | DoGreen | DoBlue;
-    
-    if (XAllocColor(m_display, colormap, &color)) {
-        return color.pixel;
+    return m_target->allocateColor(r, g, b);
+}
+
+bool UIManager::saveFrame(const std::string& path) const {
+    if (!m_image) {
+        return false;
+    }
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0) {
+        return m_image->savePNG(path);
     }
-    return m_whitePixel;
+    return m_image->savePPM(path);
 }
 
 void UIManager::handleEvents() {
+    if (!m_display) {
+        return; // Headless: no input
+    }
+    PROFILE_SCOPE(UI_EVENTS);
+    TRACE_SPAN("handleEvents", "ui");
+    
     XEvent event;
     
     while (XPending(m_display) > 0) {
@@ -104,8 +186,11 @@ void UIManager::handleEvents() {
         
         switch (event.type) {
             case Expose:
+                if (!m_frameStats.firstExposeNs) {
+                    m_frameStats.firstExposeNs = monotonicNs();
+                }
                 if (event.xexpose.count == 0) {
-                    render();
+                    requestFullRedraw();
                 }
                 break;
                 
@@ -113,81 +198,332 @@ void UIManager::handleEvents() {
                 KeySym key = XLookupKeysym(&event.xkey, 0);
                 if (key == XK_Escape) {
                     m_running = false;
-                } else if (key == XK_Return || key == XK_space) {
-                    if (m_state == UIState::WELCOME || m_state == UIState::END_GAME) {
-                        // Start new game
-                        if (m_gameEngine) {
-                            m_gameEngine->startNewGame();
-                            m_state = UIState::GAMEPLAY;
-                            m_gameLog.clear();
-                        }
+                } else if (key == XK_l) {
+                    toggleLatencyOverlay();
+                } else if (key == XK_h) {
+                    togglePerformanceHud();
+                } else if (m_state == UIState::GRID) {
+                    if (key == XK_space || key == XK_p) {
+                        togglePause();
+                    } else if (key == XK_plus || key == XK_equal || key == XK_KP_Add) {
+                        changeSpeed(1);
+                    } else if (key == XK_minus || key == XK_KP_Subtract) {
+                        changeSpeed(-1);
                     }
+                } else if (m_state == UIState::REPLAY) {
+                    handleReplayKey(key);
+                } else if (m_state == UIState::GAMEPLAY) {
+                    // Playback controls
+                    if (key == XK_space || key == XK_p) {
+                        togglePause();
+                    } else if (key == XK_Right || key == XK_n) {
+                        stepOnce();
+                    } else if (key == XK_plus || key == XK_equal || key == XK_KP_Add) {
+                        changeSpeed(1);
+                    } else if (key == XK_minus || key == XK_KP_Subtract) {
+                        changeSpeed(-1);
+                    } else if (key == XK_End || key == XK_e) {
+                        jumpToEnd();
+                    } else {
+                        handleLogKey(key);
+                    }
+                } else if (handleLogKey(key)) {
+                    // Log scrolling on the end screen
+                } else if (key == XK_Return || key == XK_space) {
+                    // Start new game
+                    startGame();
                 }
                 break;
             }
                 
             case ButtonPress:
-                if (event.xbutton.button == Button1) {
+                if (event.xbutton.button == Button1 && m_state == UIState::REPLAY &&
+                    inReplayTimeline(event.xbutton.x, event.xbutton.y)) {
+                    m_scrubbing = true;
+                    scrubReplay(event.xbutton.x);
+                } else if (event.xbutton.button == Button1) {
                     handleButtonClick(event.xbutton.x, event.xbutton.y);
+                } else if (event.xbutton.button == Button4) {
+                    scrollLog(3); // Wheel up: older entries
+                } else if (event.xbutton.button == Button5) {
+                    scrollLog(-3);
+                }
+                break;
+                
+            case ButtonRelease:
+                if (event.xbutton.button == Button1) {
+                    m_scrubbing = false;
                 }
                 break;
                 
             case MotionNotify:
                 m_mouseX = event.xmotion.x;
                 m_mouseY = event.xmotion.y;
+                if (m_scrubbing && m_state == UIState::REPLAY) {
+                    scrubReplay(m_mouseX);
+                }
                 updateButtonHover(m_mouseX, m_mouseY);
                 break;
                 
             case ConfigureNotify:
                 m_width = event.xconfigure.width;
                 m_height = event.xconfigure.height;
+                requestFullRedraw();
                 break;
         }
     }
 }
 
 void UIManager::update(float deltaTime) {
-    updateAnimations(deltaTime);
+    PROFILE_SCOPE(UI_UPDATE);
+    TRACE_SPAN("update", "ui");
+    if (m_showHud) {
+        sampleStepRate(deltaTime);
+        requestRedraw();
+    }
+    if (m_state == UIState::GRID) {
+        if (!m_paused && m_grid->update(deltaTime, getPlaybackSpeed(), m_turnDelay)) {
+            requestRedraw();
+        }
+        return;
+    }
+    
+    if (m_state == UIState::REPLAY) {
+        if (m_paused || m_scrubbing) {
+            return;
+        }
+        float interval = m_turnDelay / getPlaybackSpeed();
+        m_turnTimer += deltaTime;
+        for (int steps = 0; m_turnTimer >= interval && steps < MAX_STEPS_PER_FRAME; ++steps) {
+            m_turnTimer -= interval;
+            stepReplayTurn(1);
+        }
+        if (m_turnTimer >= interval) {
+            m_turnTimer = 0.0f;
+        }
+        if (replayAtEnd()) {
+            m_paused = true;
+        }
+        return;
+    }
+    
+    if (!animationsVisible()) {
+        finishAnimations();
+    }
+    updateAnimations(deltaTime * getPlaybackSpeed());
     
     // Auto-step game if in gameplay state and no animations
-    if (m_state == UIState::GAMEPLAY && m_animations.empty() && m_gameEngine) {
-        if (m_gameEngine->getGameState() == GameState::PLAYING) {
-            // Add delay between turns for watchable gameplay
-            m_turnTimer += deltaTime;
-            if (m_turnTimer >= m_turnDelay) {
-                m_turnTimer = 0.0f;
-                if (!m_gameEngine->stepGame()) {
-                    // Game ended
-                    m_state = UIState::END_GAME;
-                }
-            }
+    if (m_state != UIState::GAMEPLAY || m_paused || !m_tweens.empty() || !m_gameEngine) {
+        return;
+    }
+    if (m_gameEngine->getGameState() != GameState::PLAYING) {
+        return;
+    }
+    
+    // The rest of a step goes on as soon as its last animation is done
+    if (!m_turn.done()) {
+        advanceGame();
+        m_turnTimer = 0.0f;
+        return;
+    }
+    
+    // Add delay between turns for watchable gameplay; at high speeds several
+    // steps fall into one frame and share a single repaint
+    float interval = m_turnDelay / getPlaybackSpeed();
+    m_turnTimer += deltaTime;
+    int steps = 0;
+    while (m_turnTimer >= interval && steps < MAX_STEPS_PER_FRAME) {
+        m_turnTimer -= interval;
+        ++steps;
+        if (!advanceGame()) {
+            break;
         }
+        if (!m_tweens.empty()) {
+            // Let visible animations play out before the next step
+            m_turnTimer = 0.0f;
+            break;
+        }
+    }
+    
+    // Drop any backlog we could not absorb instead of falling further behind
+    if (steps == MAX_STEPS_PER_FRAME) {
+        m_turnTimer = 0.0f;
     }
 }
 
+bool UIManager::advanceGame() {
+    requestRedraw();
+    if (m_turn.done()) {
+        ++m_stepsTaken;
+        m_turn = m_gameEngine->playTurn();
+    }
+    while (resumeTurn()) {
+        if (!m_tweens.empty()) {
+            return true;
+        }
+    }
+    if (m_gameEngine->getGameState() != GameState::PLAYING) {
+        // Game ended
+        m_state = UIState::END_GAME;
+        finishAnimations();
+        return false;
+    }
+    return true;
+}
+
+// A turn can be spread over several frames while its animations play, so
+// each resume gets its own engine-step scope and "turn" span. Summed over
+// a turn they cover what one stepGame() scope does, but the profiler counts
+// a call per resume and the trace shows a span per segment.
+bool UIManager::resumeTurn() {
+    PROFILE_SCOPE(ENGINE_STEP);
+    TRACE_SPAN("turn", "engine");
+    return m_turn.next();
+}
+
+void UIManager::startGame() {
+    if (!m_gameEngine) return;
+    m_turn.reset();
+    m_gameEngine->startNewGame();
+    m_state = UIState::GAMEPLAY;
+    m_gameLog->clear();
+    m_logScroll = 0;
+    m_tweens.clear();
+    m_turnTimer = 0.0f;
+    requestRedraw();
+}
+
+void UIManager::stepOnce() {
+    if (m_state != UIState::GAMEPLAY || !m_gameEngine) return;
+    m_paused = true;
+    finishAnimations();
+    m_turnTimer = 0.0f;
+    advanceGame();
+}
+
+void UIManager::jumpToEnd() {
+    if (m_state != UIState::GAMEPLAY || !m_gameEngine) return;
+    finishAnimations();
+    for (int i = 0; i < MAX_STEPS_PER_GAME && m_state == UIState::GAMEPLAY; ++i) {
+        // Whole steps: drop each animation that would suspend one
+        do {
+            finishAnimations();
+            advanceGame();
+        } while (!m_turn.done());
+    }
+    m_turnTimer = 0.0f;
+}
+
+void UIManager::changeSpeed(int delta) {
+    m_speedIndex = std::max(0, std::min(NUM_PLAYBACK_SPEEDS - 1, m_speedIndex + delta));
+    m_turnTimer = 0.0f;
+    requestRedraw();
+}
+
+void UIManager::setPlaybackSpeed(float speed) {
+    int best = DEFAULT_SPEED_INDEX;
+    for (int i = 0; i < NUM_PLAYBACK_SPEEDS; ++i) {
+        if (std::fabs(std::log2(PLAYBACK_SPEEDS[i] / speed)) <
+            std::fabs(std::log2(PLAYBACK_SPEEDS[best] / speed))) {
+            best = i;
+        }
+    }
+    m_speedIndex = best;
+    requestRedraw();
+}
+
+float UIManager::getPlaybackSpeed() const {
+    return PLAYBACK_SPEEDS[m_speedIndex];
+}
+
 void UIManager::render() {
-    // Clear window
-    XSetForeground(m_display, m_gc, m_greenPixel);
-    XFillRectangle(m_display, m_window, m_gc, 0, 0, m_width, m_height);
+    if (!m_needsRedraw) {
+        return;
+    }
+    m_needsRedraw = false;
+    PROFILE_SCOPE(UI_RENDER);
+    TRACE_SPAN("render", "ui");
+    PROFILE_COUNT(UI_FRAMES, 1);
+    int commandsBefore = m_target->commandCount();
+    auto frameStart = std::chrono::steady_clock::now();
     
-    switch (m_state) {
-        case UIState::WELCOME:
-            renderWelcomeScreen();
-            break;
-        case UIState::GAMEPLAY:
-            renderGameplayScreen();
-            break;
-        case UIState::END_GAME:
-            renderEndGameScreen();
-            break;
+    if (m_state == UIState::GRID && !m_fullRedraw) {
+        // Only tables whose state changed are repainted
+        PROFILE_SCOPE(UI_RENDER_SCREEN);
+        renderGridScreen(false);
+    } else {
+        // Clear window
+        PROFILE_SCOPE(UI_RENDER_CLEAR);
+        m_target->resize(m_width, m_height);
+        m_target->setColor(m_greenPixel);
+        m_target->fillRect(0, 0, m_width, m_height);
     }
     
-    XFlush(m_display);
+    {
+        PROFILE_SCOPE(UI_RENDER_SCREEN);
+        switch (m_state) {
+            case UIState::WELCOME:
+                renderWelcomeScreen();
+                break;
+            case UIState::GAMEPLAY:
+            case UIState::REPLAY:
+                renderGameplayScreen();
+                break;
+            case UIState::END_GAME:
+                renderEndGameScreen();
+                break;
+            case UIState::GRID:
+                if (m_fullRedraw) {
+                    renderGridScreen(true);
+                }
+                break;
+        }
+    }
+    m_fullRedraw = false;
+    
+    if (m_showLatency && m_state != UIState::GRID) {
+        PROFILE_SCOPE(UI_RENDER_OVERLAY);
+        drawLatencyOverlay();
+    }
+    if (m_showHud) {
+        PROFILE_SCOPE(UI_RENDER_OVERLAY);
+        auto hudStart = std::chrono::steady_clock::now();
+        drawPerformanceHud();
+        m_hudMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - hudStart).count();
+    }
+    
+    {
+        PROFILE_SCOPE(UI_PRESENT);
+        m_target->present();
+    }
+    m_frameStats.lastCommands = m_target->commandCount() - commandsBefore;
+    if (m_frameStats.firstExposeNs && !m_frameStats.firstPresentNs) {
+        m_frameStats.firstPresentNs = monotonicNs();
+    }
+    PROFILE_COUNT(UI_DRAW_COMMANDS, m_frameStats.lastCommands);
+    
+    // Every event since the last present is now on screen
+    if (!m_unpresentedEvents.empty()) {
+        uint64_t presented = monotonicNs();
+        for (uint64_t emitted : m_unpresentedEvents) {
+            m_pixelLatency.record(presented - emitted);
+        }
+        m_unpresentedEvents.clear();
+    }
+    
+    m_frameStats.lastMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - frameStart).count();
+    m_frameStats.totalMs += m_frameStats.lastMs;
+    m_frameStats.maxMs = std::max(m_frameStats.maxMs, m_frameStats.lastMs);
+    ++m_frameStats.frames;
+    m_frameHistory[m_frameHistoryPos] = m_frameStats.lastMs;
+    m_frameHistoryPos = (m_frameHistoryPos + 1) % HUD_HISTORY;
 }
 
 void UIManager::renderWelcomeScreen() {
     // Draw title
-    XSetForeground(m_display, m_gc, m_whitePixel);
+    m_target->setColor(m_whitePixel);
     drawCenteredText(m_height / 3, "GO FISH GAME", true);
     drawCenteredText(m_height / 3 + 40, "AI vs AI", false);
     
@@ -207,36 +543,39 @@ void UIManager::renderWelcomeScreen() {
 void UIManager::renderGameplayScreen() {
     if (!m_gameEngine) return;
     
-    XSetForeground(m_display, m_gc, m_whitePixel);
+    m_target->setColor(m_whitePixel);
     
     // Draw AI2 (top)
     drawText(20, 30, "AI2 (Opponent)", false);
     drawText(m_width - 150, 30, "Books: " + std::to_string(m_gameEngine->getBooks2()), false);
     
     const auto& hand2 = m_gameEngine->getHand2();
-    int startX = (m_width - (hand2.size() * (CARD_WIDTH + CARD_SPACING))) / 2;
+    uint64_t incoming2 = m_tweens.incomingSlots(1);
     for (size_t i = 0; i < hand2.size(); ++i) {
-        drawCardBack(startX + i * (CARD_WIDTH + CARD_SPACING), 60);
+        if (!(incoming2 >> i & 1)) {
+            drawCardBack(handCardX(hand2.size(), i), handCardY(1));
+        }
     }
     
-    // Draw game log (smaller, more compact)
-    int logY = m_height / 2 - 60;
-    drawText(m_width / 2 - 200, logY, "Game Log:", false);
-    XDrawRectangle(m_display, m_window, m_gc, m_width / 2 - 210, logY + 10, 420, 110);
-    
-    int logStartIdx = std::max(0, (int)m_gameLog.size() - m_maxLogLines);
-    for (size_t i = logStartIdx; i < m_gameLog.size(); ++i) {
-        drawText(m_width / 2 - 200, logY + 25 + (i - logStartIdx) * 16, 
-                m_gameLog[i], false);
+    // Draw playback status
+    if (m_state == UIState::REPLAY) {
+        drawReplayStatus(m_height / 2 - 85);
+    } else {
+        char speedText[64];
+        snprintf(speedText, sizeof(speedText), "Speed: %gx%s", getPlaybackSpeed(),
+                 m_paused ? " (paused)" : "");
+        drawCenteredText(m_height / 2 - 85,
+                         std::string(speedText) + "   [P]ause [N]ext [+/-] Speed [E]nd", false);
     }
     
+    // Draw game log (smaller, more compact)
+    drawLogPanel(m_height / 2 - 60);
+    
     // Draw draw pile (moved up slightly)
-    int pileX = m_width / 2 - CARD_WIDTH / 2;
-    int pileY = m_height / 2 + 70;
-    drawText(pileX - 50, pileY - 10, "Draw Pile: " + 
+    drawText(pileX() - 50, pileY() - 10, "Draw Pile: " + 
              std::to_string(m_gameEngine->getDrawPile().size()), false);
     if (!m_gameEngine->getDrawPile().empty()) {
-        drawCardBack(pileX, pileY);
+        drawCardBack(pileX(), pileY());
     }
     
     // Draw AI1 (bottom)
@@ -245,23 +584,316 @@ void UIManager::renderGameplayScreen() {
     drawText(m_width - 150, ai1Y, "Books: " + std::to_string(m_gameEngine->getBooks1()), false);
     
     const auto& hand1 = m_gameEngine->getHand1();
-    startX = (m_width - (hand1.size() * (CARD_WIDTH + CARD_SPACING))) / 2;
+    uint64_t incoming1 = m_tweens.incomingSlots(0);
     for (size_t i = 0; i < hand1.size(); ++i) {
-        drawCard(startX + i * (CARD_WIDTH + CARD_SPACING), ai1Y + 30, hand1[i], false);
+        if (!(incoming1 >> i & 1)) {
+            drawCard(handCardX(hand1.size(), i), handCardY(0), hand1[i], false);
+        }
+    }
+    
+    // Draw cards in flight
+    for (int i = 0; i < m_tweens.size(); ++i) {
+        drawCard(m_tweens.x(i), m_tweens.y(i), m_tweens.card(i), m_tweens.faceDown(i));
+    }
+}
+
+void UIManager::enterGridMode(int columns, int rows, unsigned int seed) {
+    m_grid.reset(new TableGrid(columns, rows, seed));
+    m_state = UIState::GRID;
+    clearButtons();
+    requestFullRedraw();
+}
+
+void UIManager::enterReplayMode(std::unique_ptr<Replay> replay, int turn) {
+    if (!m_gameEngine || !replay) return;
+    m_replay = std::move(replay);
+    m_replayLogged = -1;
+    m_state = UIState::REPLAY;
+    m_turnTimer = 0.0f;
+    clearButtons();
+    turn = std::max(0, std::min(m_replay->turnCount() - 1, turn));
+    seekReplay(m_replay->turnCount() > 0 ? m_replay->turnStart(turn) : m_replay->start());
+    requestFullRedraw();
+}
+
+bool UIManager::replayAtEnd() const {
+    return m_replay && m_replayPosition >= m_replay->end();
+}
+
+// Shows the engine and log as they were after position events
+void UIManager::seekReplay(int position) {
+    position = std::max(m_replay->start(), std::min(m_replay->end(), position));
+    m_replayPosition = position;
+    m_turn.reset();
+    m_tweens.clear();
+    m_gameEngine->restore(m_replay->seek(position));
+
+    // Bring the log along by the events between the two positions; only a
+    // jump back after the ring has wrapped rebuilds it, and then just the
+    // part the ring keeps
+    if (m_replayLogged >= 0 && position >= m_replayLogged) {
+        for (int i = m_replayLogged; i < position; ++i) {
+            m_gameLog->append(m_replay->event(i));
+        }
+    } else if (m_replayLogged >= 0 && m_replayLogged <= GameLog::CAPACITY) {
+        m_gameLog->truncate(position);
+    } else {
+        m_gameLog->clear();
+        for (int i = std::max(0, position - GameLog::CAPACITY); i < position; ++i) {
+            m_gameLog->append(m_replay->event(i));
+        }
+    }
+    m_replayLogged = position;
+    m_logScroll = 0;
+    requestRedraw();
+}
+
+void UIManager::stepReplayTurn(int delta) {
+    int turn = m_replay->turnAt(m_replayPosition);
+    if (delta > 0) {
+        seekReplay(turn + 1 < m_replay->turnCount() ? m_replay->turnStart(turn + 1)
+                                                     : m_replay->end());
+    } else if (turn >= 0 && m_replayPosition > m_replay->turnStart(turn)) {
+        seekReplay(m_replay->turnStart(turn)); // Back to the start of this turn first
+    } else {
+        seekReplay(turn > 0 ? m_replay->turnStart(turn - 1) : m_replay->start());
+    }
+}
+
+bool UIManager::handleReplayKey(KeySym key) {
+    if (key == XK_space || key == XK_p) {
+        if (replayAtEnd()) {
+            seekReplay(m_replay->start());
+        }
+        togglePause();
+    } else if (key == XK_Right || key == XK_n) {
+        stepReplayTurn(1);
+    } else if (key == XK_Left || key == XK_b) {
+        stepReplayTurn(-1);
+    } else if (key == XK_period) {
+        seekReplay(m_replayPosition + 1);
+    } else if (key == XK_comma) {
+        seekReplay(m_replayPosition - 1);
+    } else if (key == XK_Home) {
+        seekReplay(m_replay->start());
+    } else if (key == XK_End || key == XK_e) {
+        seekReplay(m_replay->end());
+    } else if (key == XK_plus || key == XK_equal || key == XK_KP_Add) {
+        changeSpeed(1);
+    } else if (key == XK_minus || key == XK_KP_Subtract) {
+        changeSpeed(-1);
+    } else {
+        return handleLogKey(key);
+    }
+    return true;
+}
+
+int UIManager::replayTimelineX() const {
+    return m_width / 2 - LOG_PANEL_WIDTH / 2;
+}
+
+int UIManager::replayTimelineY() const {
+    return m_height / 2 - 115;
+}
+
+bool UIManager::inReplayTimeline(int x, int y) const {
+    return x >= replayTimelineX() - TIMELINE_SLACK &&
+           x <= replayTimelineX() + LOG_PANEL_WIDTH + TIMELINE_SLACK &&
+           y >= replayTimelineY() - TIMELINE_SLACK &&
+           y <= replayTimelineY() + TIMELINE_HEIGHT + TIMELINE_SLACK;
+}
+
+void UIManager::scrubReplay(int x) {
+    int span = m_replay->end() - m_replay->start();
+    int offset = std::max(0, std::min(LOG_PANEL_WIDTH, x - replayTimelineX()));
+    int position = m_replay->start() + (span * offset + LOG_PANEL_WIDTH / 2) / LOG_PANEL_WIDTH;
+    if (position != m_replayPosition) {
+        seekReplay(position);
+    }
+}
+
+// Position line and the timeline above it, filled up to the position
+void UIManager::drawReplayStatus(int y) {
+    char status[160];
+    int turn = m_replay->turnAt(m_replayPosition);
+    snprintf(status, sizeof(status),
+             "Replay turn %d/%d, event %d/%d   Speed: %gx%s   [P]lay [</>] Turn [,/.] Event [Home/End]",
+             turn + 1, m_replay->turnCount(), m_replayPosition, m_replay->end(),
+             getPlaybackSpeed(), m_paused ? " (paused)" : "");
+    drawCenteredText(y, status, false);
+    
+    int x = replayTimelineX();
+    int barY = replayTimelineY();
+    int span = std::max(1, m_replay->end() - m_replay->start());
+    int filled = LOG_PANEL_WIDTH * (m_replayPosition - m_replay->start()) / span;
+    m_target->drawRect(x, barY, LOG_PANEL_WIDTH, TIMELINE_HEIGHT);
+    m_target->fillRect(x, barY, filled, TIMELINE_HEIGHT);
+}
+
+void UIManager::renderGridScreen(bool fullRedraw) {
+    if (fullRedraw) {
+        m_grid->setViewport(0, GRID_STATUS_HEIGHT, m_width, m_height - GRID_STATUS_HEIGHT);
+    }
+    
+    TablePalette palette;
+    palette.table = m_greenPixel;
+    palette.border = m_buttonPixel;
+    palette.cardFace = m_whitePixel;
+    palette.cardBack = m_bluePixel;
+    palette.red = m_redPixel;
+    palette.black = m_blackPixel;
+    palette.text = m_whitePixel;
+    m_grid->render(*m_target, palette, fullRedraw);
+    
+    // Status strip
+    char status[128];
+    snprintf(status, sizeof(status), "%dx%d tables   Speed: %gx%s   Games finished: %ld   [P]ause [+/-] Speed",
+             m_grid->columns(), m_grid->rows(), getPlaybackSpeed(),
+             m_paused ? " (paused)" : "", m_grid->gamesFinished());
+    m_target->setColor(m_greenPixel);
+    m_target->fillRect(0, 0, m_width, GRID_STATUS_HEIGHT);
+    m_target->setColor(m_whitePixel);
+    drawText(10, 16, status, false);
+}
+
+void UIManager::drawLogPanel(int y) {
+    int x = m_width / 2 - LOG_PANEL_WIDTH / 2;
+    int total = m_gameLog->size();
+    int maxScroll = std::max(0, total - m_maxLogLines);
+    m_logScroll = std::min(m_logScroll, maxScroll);
+    
+    char title[64];
+    if (m_logScroll > 0) {
+        snprintf(title, sizeof(title), "Game Log: (%d more below, End to follow)", m_logScroll);
+    } else {
+        snprintf(title, sizeof(title), "Game Log:");
+    }
+    drawText(x + 10, y, title, false);
+    m_target->drawRect(x, y + 10, LOG_PANEL_WIDTH, m_maxLogLines * LOG_ROW_HEIGHT + 14);
+    
+    // Only the rows on screen are formatted and drawn
+    int first = std::max(0, total - m_maxLogLines - m_logScroll);
+    int last = std::min(total, first + m_maxLogLines);
+    char line[96];
+    for (int i = first; i < last; ++i) {
+        int length = GameLog::format(m_gameLog->at(i), line, sizeof(line));
+        m_target->drawText(x + 10, y + 25 + (i - first) * LOG_ROW_HEIGHT, line, length);
+    }
+    
+    // Scrollbar showing the visible window within the whole history
+    if (total > m_maxLogLines) {
+        int trackY = y + 12;
+        int trackH = m_maxLogLines * LOG_ROW_HEIGHT + 10;
+        int thumbH = std::max(4, trackH * m_maxLogLines / total);
+        int thumbY = trackY + (trackH - thumbH) * first / maxScroll;
+        m_target->fillRect(x + LOG_PANEL_WIDTH - 6, thumbY, 4, thumbH);
+    }
+}
+
+void UIManager::drawLatencyOverlay() {
+    const int x = 10;
+    const int y = 200;
+    char line[128];
+    
+    m_target->setColor(m_blackPixel);
+    m_target->fillRect(x, y, 380, 56);
+    m_target->setColor(m_whitePixel);
+    m_target->drawRect(x, y, 380, 56);
+    drawText(x + 8, y + 16, "Latency from event (L to hide)", false);
+    
+    int length = snprintf(line, sizeof(line), "sound ");
+    if (m_audio && m_audio->isEnabled()) {
+        length += m_audio->getSoundLatency().format(line + length, sizeof(line) - length);
+    } else {
+        length += snprintf(line + length, sizeof(line) - length, "audio off");
+    }
+    m_target->drawText(x + 8, y + 32, line, length);
+    
+    length = snprintf(line, sizeof(line), "pixel ");
+    length += m_pixelLatency.format(line + length, sizeof(line) - length);
+    m_target->drawText(x + 8, y + 48, line, length);
+}
+
+void UIManager::sampleStepRate(float deltaTime) {
+    m_stepSampleTime += deltaTime;
+    if (m_stepSampleTime < HUD_RATE_INTERVAL) {
+        return;
     }
+    long steps = m_state == UIState::GRID ? m_grid->stepsTaken() : m_stepsTaken;
+    m_stepsPerSecond = (steps - m_stepsAtSample) / m_stepSampleTime;
+    m_stepsAtSample = steps;
+    m_stepSampleTime = 0.0f;
+}
+
+void UIManager::drawPerformanceHud() {
+    const int graphHeight = 30;
+    const int width = HUD_HISTORY * 2 + 16;
+    const int height = graphHeight + 96;
+    const int x = m_width - width - 10;
+    const int y = m_state == UIState::GRID ? GRID_STATUS_HEIGHT + 10 : 190;
+    char line[96];
+    int length;
+    
+    m_target->setColor(m_blackPixel);
+    m_target->fillRect(x, y, width, height);
+    m_target->setColor(m_whitePixel);
+    m_target->drawRect(x, y, width, height);
+    
+    // Everything below comes from counters kept anyway; nothing is re-measured
+    length = snprintf(line, sizeof(line), "Frame %.2f ms  max %.2f  HUD %.3f",
+                      m_frameStats.lastMs, m_frameStats.maxMs, m_hudMs);
+    m_target->drawText(x + 8, y + 16, line, length);
     
-    // Draw animations
-    for (const auto& anim : m_animations) {
-        if (anim.active) {
-            drawCard(anim.currentX, anim.currentY, anim.card, false);
+    // Frame time graph, oldest on the left, clipped at HUD_GRAPH_MS
+    int graphY = y + 24;
+    for (int i = 0; i < HUD_HISTORY; ++i) {
+        float ms = m_frameHistory[(m_frameHistoryPos + i) % HUD_HISTORY];
+        int bar = std::min(graphHeight, (int)(ms / HUD_GRAPH_MS * graphHeight + 0.5f));
+        if (bar > 0) {
+            m_target->fillRect(x + 8 + i * 2, graphY + graphHeight - bar, 2, bar);
         }
     }
+    m_target->drawRect(x + 7, graphY - 1, HUD_HISTORY * 2 + 1, graphHeight + 1);
+    
+    int textY = graphY + graphHeight + 16;
+    length = snprintf(line, sizeof(line), "Draw commands/frame %d", m_frameStats.lastCommands);
+    m_target->drawText(x + 8, textY, line, length);
+    length = snprintf(line, sizeof(line), "Steps/s %.0f  Speed %gx%s", m_stepsPerSecond,
+                      getPlaybackSpeed(), m_paused ? " (paused)" : "");
+    m_target->drawText(x + 8, textY + 16, line, length);
+    length = snprintf(line, sizeof(line), "Events queued %zu  Audio cmds %zu",
+                      m_unpresentedEvents.size(), m_audio ? m_audio->getQueuedCommands() : (size_t)0);
+    m_target->drawText(x + 8, textY + 32, line, length);
+    length = snprintf(line, sizeof(line), "Tweens %d  Voices %d", m_tweens.size(),
+                      m_audio ? m_audio->getActiveVoices() : 0);
+    m_target->drawText(x + 8, textY + 48, line, length);
+}
+
+void UIManager::scrollLog(int lines) {
+    if (m_state != UIState::GAMEPLAY && m_state != UIState::END_GAME &&
+        m_state != UIState::REPLAY) return;
+    int maxScroll = std::max(0, m_gameLog->size() - m_maxLogLines);
+    m_logScroll = std::max(0, std::min(maxScroll, m_logScroll + lines));
+    requestRedraw();
+}
+
+bool UIManager::handleLogKey(KeySym key) {
+    int maxScroll = std::max(0, m_gameLog->size() - m_maxLogLines);
+    switch (key) {
+        case XK_Up:        scrollLog(1); return true;
+        case XK_Down:      scrollLog(-1); return true;
+        case XK_Page_Up:   scrollLog(m_maxLogLines); return true;
+        case XK_Page_Down: scrollLog(-m_maxLogLines); return true;
+        case XK_Home:      scrollLog(maxScroll); return true;
+        case XK_End:       scrollLog(-maxScroll); return true; // Resume following
+        default:           return false;
+    }
 }
 
 void UIManager::renderEndGameScreen() {
     if (!m_gameEngine) return;
     
-    XSetForeground(m_display, m_gc, m_whitePixel);
+    m_target->setColor(m_whitePixel);
     
     // Draw game over message
     drawCenteredText(m_height / 3, "GAME OVER!", true);
@@ -287,23 +919,20 @@ void UIManager::renderEndGameScreen() {
     for (const auto& button : m_buttons) {
         drawButton(button);
     }
+    
+    // The finished game's log stays browsable
+    drawLogPanel(m_height / 2 + 210);
 }
 
 void UIManager::drawButton(const Button& button) {
     // Draw button background
-    if (button.hovered) {
-        unsigned long hoverColor = allocateColor(100, 150, 100);
-        XSetForeground(m_display, m_gc, hoverColor);
-    } else {
-        unsigned long buttonColor = allocateColor(50, 100, 50);
-        XSetForeground(m_display, m_gc, buttonColor);
-    }
-    XFillRectangle(m_display, m_window, m_gc, button.x, button.y, 
+    m_target->setColor(button.hovered ? m_buttonHoverPixel : m_buttonPixel);
+    m_target->fillRect(button.x, button.y, 
                    button.width, button.height);
     
     // Draw button border
-    XSetForeground(m_display, m_gc, m_whitePixel);
-    XDrawRectangle(m_display, m_window, m_gc, button.x, button.y, 
+    m_target->setColor(m_whitePixel);
+    m_target->drawRect(button.x, button.y, 
                    button.width, button.height);
     
     // Draw button text (centered)
@@ -319,18 +948,18 @@ void UIManager::drawCard(int x, int y, const Card& card, bool faceDown) {
     }
     
     // Draw card background (white)
-    XSetForeground(m_display, m_gc, m_whitePixel);
-    XFillRectangle(m_display, m_window, m_gc, x, y, CARD_WIDTH, CARD_HEIGHT);
+    m_target->setColor(m_whitePixel);
+    m_target->fillRect(x, y, CARD_WIDTH, CARD_HEIGHT);
     
     // Draw card border
-    XSetForeground(m_display, m_gc, m_blackPixel);
-    XDrawRectangle(m_display, m_window, m_gc, x, y, CARD_WIDTH, CARD_HEIGHT);
+    m_target->setColor(m_blackPixel);
+    m_target->drawRect(x, y, CARD_WIDTH, CARD_HEIGHT);
     
     // Set color based on suit (red for hearts/diamonds, black for clubs/spades)
     if (card.suit == 0 || card.suit == 1) {
-        XSetForeground(m_display, m_gc, m_redPixel);
+        m_target->setColor(m_redPixel);
     } else {
-        XSetForeground(m_display, m_gc, m_blackPixel);
+        m_target->setColor(m_blackPixel);
     }
     
     // Draw rank in corners
@@ -354,24 +983,24 @@ void UIManager::drawCard(int x, int y, const Card& card, bool faceDown) {
 
 void UIManager::drawCardBack(int x, int y) {
     // Draw card background (blue)
-    XSetForeground(m_display, m_gc, m_bluePixel);
-    XFillRectangle(m_display, m_window, m_gc, x, y, CARD_WIDTH, CARD_HEIGHT);
+    m_target->setColor(m_bluePixel);
+    m_target->fillRect(x, y, CARD_WIDTH, CARD_HEIGHT);
     
     // Draw card border
-    XSetForeground(m_display, m_gc, m_whitePixel);
-    XDrawRectangle(m_display, m_window, m_gc, x, y, CARD_WIDTH, CARD_HEIGHT);
+    m_target->setColor(m_whitePixel);
+    m_target->drawRect(x, y, CARD_WIDTH, CARD_HEIGHT);
     
     // Draw pattern
     for (int i = 0; i < 3; ++i) {
         for (int j = 0; j < 4; ++j) {
-            XDrawRectangle(m_display, m_window, m_gc, 
+            m_target->drawRect(
                           x + 10 + i * 20, y + 10 + j * 25, 15, 20);
         }
     }
 }
 
 void UIManager::drawText(int x, int y, const std::string& text, bool large) {
-    XDrawString(m_display, m_window, m_gc, x, y, text.c_str(), text.length());
+    m_target->drawText(x, y, text.c_str(), text.length());
 }
 
 void UIManager::drawCenteredText(int y, const std::string& text, bool large) {
@@ -410,7 +1039,7 @@ void UIManager::updateButtonHover(int x, int y) {
         }
     }
     if (needsRedraw) {
-        render();
+        requestRedraw();
     }
 }
 
@@ -418,12 +1047,7 @@ void UIManager::handleButtonClick(int x, int y) {
     for (const auto& button : m_buttons) {
         if (isPointInButton(x, y, button)) {
             if (button.label == "NEW GAME") {
-                if (m_gameEngine) {
-                    m_gameEngine->startNewGame();
-                    m_state = UIState::GAMEPLAY;
-                    m_gameLog.clear();
-                    render();
-                }
+                startGame();
             } else if (button.label == "EXIT") {
                 m_running = false;
             }
@@ -431,73 +1055,139 @@ void UIManager::handleButtonClick(int x, int y) {
     }
 }
 
-void UIManager::addCardAnimation(const Card& card, int startX, int startY, int endX, int endY) {
-    CardAnimation anim;
-    anim.card = card;
-    anim.startX = startX;
-    anim.startY = startY;
-    anim.endX = endX;
-    anim.endY = endY;
-    anim.currentX = startX;
-    anim.currentY = startY;
-    anim.progress = 0.0f;
-    anim.active = true;
-    m_animations.push_back(anim);
+void UIManager::addCardAnimation(const Card& card, int startX, int startY, int endX, int endY,
+                                 float delay, bool faceDown, int destHand, int destIndex) {
+    if (!animationsVisible()) {
+        return;
+    }
+    if (destIndex >= 64) {
+        destIndex = -1;
+    }
+    m_tweens.add(card, faceDown, startX, startY, endX, endY,
+                 delay, TWEEN_DURATION, destHand, destIndex);
 }
 
 void UIManager::updateAnimations(float deltaTime) {
-    bool needsRedraw = false;
+    if (m_tweens.empty()) {
+        return;
+    }
+    m_tweens.advance(deltaTime);
     
-    for (auto& anim : m_animations) {
-        if (anim.active) {
-            anim.progress += deltaTime * 1.0f; // 1.0 second animation
-            
-            if (anim.progress >= 1.0f) {
-                anim.progress = 1.0f;
-                anim.active = false;
-            }
-            
-            // Ease-in-out interpolation
-            float t = anim.progress;
-            float eased = t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
-            
-            anim.currentX = anim.startX + (anim.endX - anim.startX) * eased;
-            anim.currentY = anim.startY + (anim.endY - anim.startY) * eased;
-            
-            needsRedraw = true;
-        }
+    // Keep repainting while cards are moving, plus the frame that lands them
+    requestRedraw();
+}
+
+bool UIManager::animationsVisible() const {
+    // A 1-second animation runs for 1/speed seconds of wall time
+    return 1.0f / getPlaybackSpeed() >= MIN_VISIBLE_ANIMATION;
+}
+
+void UIManager::finishAnimations() {
+    if (!m_tweens.empty()) {
+        m_tweens.clear();
+        requestRedraw();
     }
+}
+
+int UIManager::handCardX(int handSize, int index) const {
+    return (m_width - handSize * (CARD_WIDTH + CARD_SPACING)) / 2 +
+           index * (CARD_WIDTH + CARD_SPACING);
+}
+
+int UIManager::handCardY(int hand) const {
+    return hand == 0 ? m_height - 150 : 60;
+}
+
+int UIManager::pileX() const {
+    return m_width / 2 - CARD_WIDTH / 2;
+}
+
+int UIManager::pileY() const {
+    return m_height / 2 + 70;
+}
+
+int UIManager::booksX() const {
+    return m_width - CARD_WIDTH - 20;
+}
+
+int UIManager::booksY(int hand) const {
+    return hand == 0 ? m_height - 150 : 60;
+}
+
+void UIManager::animateTransfer(const GameEvent& event) {
+    // Emitted before the cards move: hands still hold their old contents
+    int to = handIndex(event.player);
+    int from = 1 - to;
+    const auto& pHand = to == 0 ? m_gameEngine->getHand1() : m_gameEngine->getHand2();
+    const auto& oHand = to == 0 ? m_gameEngine->getHand2() : m_gameEngine->getHand1();
+    int newSize = pHand.size() + event.count;
     
-    // Remove completed animations
-    m_animations.erase(
-        std::remove_if(m_animations.begin(), m_animations.end(),
-                      [](const CardAnimation& a) { return !a.active; }),
-        m_animations.end()
-    );
+    float delay = m_tweens.timeUntilIdle();
+    int moved = 0;
+    for (size_t i = 0; i < oHand.size(); ++i) {
+        const Card& c = oHand[i];
+        if (c.rank != event.rank) continue;
+        
+        // Final slot = cards that will sort before this one in the merged hand
+        int dest = std::lower_bound(pHand.begin(), pHand.end(), c) - pHand.begin() + moved;
+        addCardAnimation(c, handCardX(oHand.size(), i), handCardY(from),
+                         handCardX(newSize, dest), handCardY(to),
+                         delay + moved * TWEEN_STAGGER, false, to, dest);
+        ++moved;
+    }
+}
+
+void UIManager::animateDraw(const GameEvent& event) {
+    // Emitted after the card has been added to the (sorted) hand
+    int to = handIndex(event.player);
+    const auto& hand = to == 0 ? m_gameEngine->getHand1() : m_gameEngine->getHand2();
+    const Card& c = event.drawnCard;
+    int dest = std::lower_bound(hand.begin(), hand.end(), c) - hand.begin();
+    addCardAnimation(c, pileX(), pileY(), handCardX(hand.size(), dest), handCardY(to),
+                     m_tweens.timeUntilIdle(), to == 1, to, dest);
+}
+
+void UIManager::animateBook(const GameEvent& event) {
+    // Emitted after the four cards left the hand; they sat where the rank sorts
+    int owner = handIndex(event.player);
+    const auto& hand = owner == 0 ? m_gameEngine->getHand1() : m_gameEngine->getHand2();
+    int first = std::lower_bound(hand.begin(), hand.end(), Card{event.rank, 0}) - hand.begin();
+    int oldSize = hand.size() + 4;
+    m_tweens.releaseSlots(owner);
     
-    if (needsRedraw) {
-        render();
+    float delay = m_tweens.timeUntilIdle();
+    for (int suit = 0; suit < 4; ++suit) {
+        addCardAnimation(Card{event.rank, suit},
+                         handCardX(oldSize, first + suit), handCardY(owner),
+                         booksX(), booksY(owner), delay + suit * TWEEN_STAGGER);
     }
 }
 
 void UIManager::onGameEvent(const GameEvent& event) {
-    addLogMessage(event.message);
-    
-    // Add visual feedback for book formation
-    if (event.type == EventType::BOOK_FORMED) {
-        std::string bookMsg = "*** BOOK FORMED: " + event.message + " ***";
-        addLogMessage(bookMsg);
+    m_gameLog->append(event);
+    if (event.timestamp && m_unpresentedEvents.size() < MAX_UNPRESENTED_EVENTS) {
+        m_unpresentedEvents.push_back(event.timestamp);
+    }
+    if (m_logScroll > 0) {
+        ++m_logScroll; // Keep a scrolled-back view anchored on the same rows
     }
     
     // Trigger animations based on event type
-    // (This would be expanded with actual card positions)
-    
-    render();
-}
-
-void UIManager::addLogMessage(const std::string& message) {
-    m_gameLog.push_back(message);
-    if (m_gameLog.size() > 50) {
-        m_gameLog.erase(m_gameLog.begin());
+    if (m_gameEngine && animationsVisible()) {
+        switch (event.type) {
+            case EventType::CARDS_TRANSFERRED:
+                animateTransfer(event);
+                break;
+            case EventType::CARD_DRAWN:
+                animateDraw(event);
+                break;
+            case EventType::BOOK_FORMED:
+                animateBook(event);
+                break;
+            default:
+                break;
+        }
     }
+    
+    requestRedraw();
 }
\ No newline at end of file
@@ -3,14 +3,36 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <memory>
 #include <string>
 #include <vector>
 #include "GameEngine.h"
+#include "CardTweenPool.h"
+#include "LatencyHistogram.h"
+#include "RenderTarget.h"
+
+class ImageRenderTarget;
+class Replay;
+class TableGrid;
+class GameLog;
+class AudioManager;
 
 enum class UIState {
     WELCOME,
     GAMEPLAY,
-    END_GAME
+    END_GAME,
+    GRID,  // Spectator view of many simultaneous tables
+    REPLAY // A recorded game, scrubbed by turn, event or timeline
+};
+
+struct FrameStats {
+    long frames = 0;
+    double lastMs = 0.0;
+    double totalMs = 0.0;
+    double maxMs = 0.0;
+    int lastCommands = 0; // Draw commands issued by the last frame
+    uint64_t firstExposeNs = 0;  // monotonicNs() of the window's first Expose
+    uint64_t firstPresentNs = 0; // First frame presented after it
 };
 
 struct Button {
@@ -19,31 +41,62 @@ struct Button {
     bool hovered;
 };
 
-struct CardAnimation {
-    Card card;
-    int startX, startY;
-    int endX, endY;
-    int currentX, currentY;
-    float progress; // 0.0 to 1.0
-    bool active;
-};
-
 class UIManager {
 public:
     UIManager();
     ~UIManager();
     
     bool initialize(int width, int height);
+    bool initializeHeadless(int width, int height); // Offscreen, no X server needed
     void cleanup();
     
-    void setGameEngine(GameEngine* engine) { m_gameEngine = engine; }
+    void setGameEngine(GameEngine* engine) {
+        m_turn.reset();
+        m_gameEngine = engine;
+    }
     
     void handleEvents();
     void update(float deltaTime);
-    void render();
+    void render(); // Repaints only if something changed since the last frame
+    
+    // Playback control
+    void togglePause() { m_paused = !m_paused; requestRedraw(); }
+    void stepOnce();
+    void jumpToEnd();
+    void changeSpeed(int delta);
+    float getPlaybackSpeed() const;
+    void setPlaybackSpeed(float speed); // Picks the closest supported speed
+    bool isPaused() const { return m_paused; }
     
     bool isRunning() const { return m_running; }
     UIState getState() const { return m_state; }
+    void startGame();
+    void enterGridMode(int columns, int rows, unsigned int seed);
+    // Shows replay through the engine, starting at the given turn; while
+    // playing, the position advances a turn per turn delay
+    void enterReplayMode(std::unique_ptr<Replay> replay, int turn = 0);
+    bool replayAtEnd() const;
+    void requestRedraw() { m_needsRedraw = true; }
+    void requestFullRedraw() { m_needsRedraw = true; m_fullRedraw = true; }
+    
+    // Frame timing and offscreen capture
+    const FrameStats& getFrameStats() const { return m_frameStats; }
+    bool saveFrame(const std::string& path) const; // .png or PPM; headless only
+    
+    // Latency from a game event's emission to the first frame presented after
+    // it; the overlay also shows the event-to-sound histogram if audio is set
+    const LatencyHistogram& getPixelLatency() const { return m_pixelLatency; }
+    void toggleLatencyOverlay() { m_showLatency = !m_showLatency; requestRedraw(); }
+    
+    // Performance HUD: frame time graph, draw commands, steps/s, queues,
+    // tweens and voices. While shown the screen repaints every frame.
+    void togglePerformanceHud() { m_showHud = !m_showHud; requestFullRedraw(); }
+    
+    // Source of the audio figures in the overlays; may be null
+    void setAudioManager(const AudioManager* audio) { m_audio = audio; }
+    
+    // Game event handling (hooked up to GameEngine's event callback)
+    void onGameEvent(const GameEvent& event);
     
 private:
     // X11 resources
@@ -56,6 +109,13 @@ private:
     unsigned long m_greenPixel;
     unsigned long m_redPixel;
     unsigned long m_bluePixel;
+    unsigned long m_buttonPixel;
+    unsigned long m_buttonHoverPixel;
+    
+    // Drawing backend (X11 window or offscreen image)
+    std::unique_ptr<RenderTarget> m_target;
+    ImageRenderTarget* m_image; // Same object as m_target when headless
+    FrameStats m_frameStats;
     
     // Window properties
     int m_width;
@@ -65,29 +125,63 @@ private:
     // UI state
     UIState m_state;
     GameEngine* m_gameEngine;
+    Generator<EventType> m_turn; // Engine step in progress, suspended while an event animates
     
     // Buttons
     std::vector<Button> m_buttons;
     
     // Animations
-    std::vector<CardAnimation> m_animations;
+    CardTweenPool m_tweens;
     
     // Game log
-    std::vector<std::string> m_gameLog;
-    int m_maxLogLines;
+    std::unique_ptr<GameLog> m_gameLog;
+    int m_maxLogLines; // Rows visible in the log panel
+    int m_logScroll;   // Rows scrolled back from the newest entry
     
     // Turn delay for watchable gameplay
     float m_turnDelay;
     float m_turnTimer;
     
+    // Playback state (m_turnDelay is scaled by the selected speed)
+    int m_speedIndex;
+    bool m_paused;
+    bool m_needsRedraw;
+    bool m_fullRedraw; // Repaint everything, not just the changed grid tables
+    
+    // Multi-table spectator grid (GRID state only)
+    std::unique_ptr<TableGrid> m_grid;
+    
+    // Replay viewer (REPLAY state only)
+    std::unique_ptr<Replay> m_replay;
+    int m_replayPosition; // Events played
+    int m_replayLogged;   // Replay events in the game log, -1 while it holds another game
+    bool m_scrubbing;     // Dragging on the timeline
+    
     // Mouse state
     int m_mouseX;
     int m_mouseY;
     
+    // Latency instrumentation
+    LatencyHistogram m_pixelLatency;
+    std::vector<uint64_t> m_unpresentedEvents; // Emission times awaiting a present
+    bool m_showLatency;
+    const AudioManager* m_audio;
+    
+    // Performance HUD
+    bool m_showHud;
+    std::vector<float> m_frameHistory; // Ring of recent frame times (ms)
+    int m_frameHistoryPos;
+    double m_hudMs;          // Cost of drawing the HUD itself last frame
+    long m_stepsTaken;       // Engine steps driven by this UI
+    long m_stepsAtSample;
+    double m_stepsPerSecond;
+    float m_stepSampleTime;  // Seconds accumulated since the last rate sample
+    
     // Rendering methods
     void renderWelcomeScreen();
     void renderGameplayScreen();
     void renderEndGameScreen();
+    void renderGridScreen(bool fullRedraw);
     
     void drawButton(const Button& button);
     void drawCard(int x, int y, const Card& card, bool faceDown = false);
@@ -103,15 +197,52 @@ private:
     void handleButtonClick(int x, int y);
     
     // Animation
-    void addCardAnimation(const Card& card, int startX, int startY, int endX, int endY);
+    void addCardAnimation(const Card& card, int startX, int startY, int endX, int endY,
+                          float delay = 0.0f, bool faceDown = false,
+                          int destHand = -1, int destIndex = -1);
     void updateAnimations(float deltaTime);
-    
-    // Game event handling
-    void onGameEvent(const GameEvent& event);
-    void addLogMessage(const std::string& message);
+    bool animationsVisible() const;
+    void finishAnimations();
+    void animateTransfer(const GameEvent& event);
+    void animateDraw(const GameEvent& event);
+    void animateBook(const GameEvent& event);
+    
+    // Table layout (hand 0 = AI1 at the bottom, hand 1 = AI2 at the top)
+    int handCardX(int handSize, int index) const;
+    int handCardY(int hand) const;
+    int pileX() const;
+    int pileY() const;
+    int booksX() const;
+    int booksY(int hand) const;
+    static int handIndex(const std::string& player) { return player == "AI2" ? 1 : 0; }
+    
+    // Playback helpers
+    // Runs the engine step in progress, or a new one, up to the next event
+    // that starts an animation; returns false once the game is over
+    bool advanceGame();
+    bool resumeTurn(); // One timed, traced resume of m_turn
+    
+    // Replay helpers
+    void seekReplay(int position);
+    void stepReplayTurn(int delta); // To the start of the next or previous turn
+    bool handleReplayKey(KeySym key);
+    void drawReplayStatus(int y);
+    int replayTimelineX() const;
+    int replayTimelineY() const;
+    bool inReplayTimeline(int x, int y) const;
+    void scrubReplay(int x);
+    
+    // Game log panel
+    void drawLogPanel(int y);
+    void drawLatencyOverlay();
+    void drawPerformanceHud();
+    void sampleStepRate(float deltaTime);
+    void scrollLog(int lines); // Positive = towards older entries
+    bool handleLogKey(KeySym key);
     
     // Color allocation
     unsigned long allocateColor(int r, int g, int b);
+    void allocateColors();
 };
 
 #endif // UIMANAGER_H
\ No newline at end of file
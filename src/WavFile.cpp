@@ -0,0 +1,105 @@
+#include "WavFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+uint16_t read16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t read32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// One input sample as 16-bit signed
+int sampleAt(const WavInfo& info, size_t frame, int channel) {
+    size_t index = frame * info.channels + channel;
+    if (info.bitsPerSample == 8) {
+        return ((int)info.samples[index] - 128) << 8;
+    }
+    return (int16_t)read16(info.samples + index * 2);
+}
+
+} // namespace
+
+bool parseWav(const uint8_t* bytes, size_t size, WavInfo& info, std::string& error) {
+    if (size < 12 || memcmp(bytes, "RIFF", 4) != 0 || memcmp(bytes + 8, "WAVE", 4) != 0) {
+        error = "not a RIFF/WAVE file";
+        return false;
+    }
+
+    bool haveFormat = false;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = bytes + pos;
+        uint32_t chunkSize = read32(chunk + 4);
+        size_t available = std::min<size_t>(chunkSize, size - pos - 8);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (available < 16) {
+                error = "truncated fmt chunk";
+                return false;
+            }
+            uint16_t formatTag = read16(chunk + 8);
+            if (formatTag == 0xFFFE && available >= 26) {
+                formatTag = read16(chunk + 8 + 24); // WAVE_FORMAT_EXTENSIBLE sub-format
+            }
+            info.channels = read16(chunk + 10);
+            info.sampleRate = read32(chunk + 12);
+            info.bitsPerSample = read16(chunk + 22);
+            if (formatTag != 1) {
+                error = "unsupported encoding (only integer PCM)";
+                return false;
+            }
+            if (info.channels < 1 || info.channels > 2) {
+                error = "unsupported channel count";
+                return false;
+            }
+            if (info.bitsPerSample != 8 && info.bitsPerSample != 16) {
+                error = "unsupported sample size (only 8 or 16 bits)";
+                return false;
+            }
+            if (info.sampleRate < 1000 || info.sampleRate > 192000) {
+                error = "unsupported sample rate";
+                return false;
+            }
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) {
+                error = "data chunk before fmt chunk";
+                return false;
+            }
+            // A truncated data chunk is accepted; the partial frame is dropped
+            info.samples = chunk + 8;
+            info.frames = available / (info.channels * info.bitsPerSample / 8);
+            return true;
+        }
+        pos += 8 + chunkSize + (chunkSize & 1); // Chunks are word aligned
+    }
+
+    error = haveFormat ? "missing data chunk" : "missing fmt chunk";
+    return false;
+}
+
+void convertWav(const WavInfo& info, const AudioFormat& format, std::vector<int16_t>& pcm) {
+    size_t outFrames = info.frames * (uint64_t)format.sampleRate / info.sampleRate;
+    pcm.assign(outFrames * format.channels, 0);
+    if (info.frames == 0) {
+        return;
+    }
+
+    double step = (double)info.sampleRate / format.sampleRate;
+    for (size_t i = 0; i < outFrames; ++i) {
+        double position = i * step;
+        size_t frame = (size_t)position;
+        size_t next = std::min(frame + 1, info.frames - 1);
+        double frac = position - frame;
+        for (int c = 0; c < format.channels; ++c) {
+            int source = std::min(c, info.channels - 1); // Mono feeds every channel
+            double a = sampleAt(info, frame, source);
+            double b = sampleAt(info, next, source);
+            pcm[i * format.channels + c] = (int16_t)(a + (b - a) * frac);
+        }
+    }
+}
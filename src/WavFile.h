@@ -0,0 +1,27 @@
+#ifndef WAVFILE_H
+#define WAVFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioSink.h"
+
+// Location and format of the PCM samples inside a RIFF/WAVE image
+struct WavInfo {
+    int sampleRate = 0;
+    int channels = 0;
+    int bitsPerSample = 0;
+    const uint8_t* samples = nullptr; // Points into the parsed buffer
+    size_t frames = 0;
+};
+
+// Validate a WAV file held in memory. Accepts 8/16-bit integer PCM with one
+// or two channels; on failure `error` says why.
+bool parseWav(const uint8_t* bytes, size_t size, WavInfo& info, std::string& error);
+
+// Convert parsed samples to interleaved 16-bit PCM in the output format,
+// remapping channels and resampling linearly if the rates differ
+void convertWav(const WavInfo& info, const AudioFormat& format, std::vector<int16_t>& pcm);
+
+#endif // WAVFILE_H
@@ -0,0 +1,78 @@
+#include "X11RenderTarget.h"
+
+X11RenderTarget::X11RenderTarget(Display* display, int screen, Window window, GC gc)
+    : m_display(display), m_screen(screen), m_window(window), m_gc(gc), m_commands(0) {
+}
+
+namespace {
+
+// An 8-bit component placed in a TrueColor channel mask
+unsigned long channel(int value, unsigned long mask) {
+    int shift = __builtin_ctzl(mask);
+    unsigned long maximum = mask >> shift;
+    return ((value * maximum + 127) / 255) << shift;
+}
+
+} // namespace
+
+// TrueColor pixels are computed from the visual's masks, saving a server
+// round trip per color at startup; other visuals ask the colormap
+unsigned long X11RenderTarget::allocateColor(int r, int g, int b) {
+    Visual* visual = DefaultVisual(m_display, m_screen);
+    if (visual->c_class == TrueColor && visual->red_mask && visual->green_mask &&
+        visual->blue_mask) {
+        return channel(r, visual->red_mask) | channel(g, visual->green_mask) |
+               channel(b, visual->blue_mask);
+    }
+    
+    XColor color;
+    Colormap colormap = DefaultColormap(m_display, m_screen);
+
+    color.red = r * 257;
+    color.green = g * 257;
+    color.blue = b * 257;
+    color.flags = DoRed | DoGreen | DoBlue;
+
+    if (XAllocColor(m_display, colormap, &color)) {
+        return color.pixel;
+    }
+    return whitePixel();
+}
+
+unsigned long X11RenderTarget::blackPixel() const {
+    return BlackPixel(m_display, m_screen);
+}
+
+unsigned long X11RenderTarget::whitePixel() const {
+    return WhitePixel(m_display, m_screen);
+}
+
+void X11RenderTarget::setColor(unsigned long pixel) {
+    XSetForeground(m_display, m_gc, pixel);
+    ++m_commands;
+}
+
+void X11RenderTarget::fillRect(int x, int y, int width, int height) {
+    XFillRectangle(m_display, m_window, m_gc, x, y, width, height);
+    ++m_commands;
+}
+
+void X11RenderTarget::drawRect(int x, int y, int width, int height) {
+    XDrawRectangle(m_display, m_window, m_gc, x, y, width, height);
+    ++m_commands;
+}
+
+void X11RenderTarget::drawText(int x, int y, const char* text, int length) {
+    XDrawString(m_display, m_window, m_gc, x, y, text, length);
+    ++m_commands;
+}
+
+void X11RenderTarget::resize(int width, int height) {
+    // The window itself is resized by the window manager
+    (void)width;
+    (void)height;
+}
+
+void X11RenderTarget::present() {
+    XFlush(m_display);
+}
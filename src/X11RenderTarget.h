@@ -0,0 +1,35 @@
+#ifndef X11RENDERTARGET_H
+#define X11RENDERTARGET_H
+
+#include <X11/Xlib.h>
+#include "RenderTarget.h"
+
+// Draws straight into an X11 window. The display, window and GC are owned
+// by the caller (UIManager), which also handles the X event stream.
+class X11RenderTarget : public RenderTarget {
+public:
+    X11RenderTarget(Display* display, int screen, Window window, GC gc);
+
+    unsigned long allocateColor(int r, int g, int b) override;
+    unsigned long blackPixel() const override;
+    unsigned long whitePixel() const override;
+
+    void setColor(unsigned long pixel) override;
+    void fillRect(int x, int y, int width, int height) override;
+    void drawRect(int x, int y, int width, int height) override;
+    void drawText(int x, int y, const char* text, int length) override;
+
+    void resize(int width, int height) override;
+    void present() override;
+
+    int commandCount() const override { return m_commands; }
+
+private:
+    Display* m_display;
+    int m_screen;
+    Window m_window;
+    GC m_gc;
+    int m_commands;
+};
+
+#endif // X11RENDERTARGET_H
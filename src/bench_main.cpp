@@ -0,0 +1,944 @@
+// Command-line benchmarks for the parts of the game that have to keep up
+// with fast-forwarded play. Run without arguments for the list.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AllocTracker.h"
+#include "AudioEngine.h"
+#include "BatchEngine.h"
+#include "DealCache.h"
+#include "GameEngine.h"
+#include "Mixer.h"
+#include "Profiler.h"
+#include "Replay.h"
+#include "SpscRing.h"
+#include "Tracer.h"
+#include "Tournament.h"
+#include "TranspositionTable.h"
+
+namespace {
+
+const int BENCH_CHANNELS = 2;
+const int BENCH_PERIOD_FRAMES = 512;
+
+void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " <benchmark> [options] [--trace FILE]\n"
+              << "  engine [--games N] [--seed S] [--sink none|null|callback|record] [--strategy AI2]\n"
+              << "                        Whole games without UI or audio\n"
+              << "  batch [--games N] [--seed S] [--cache]\n"
+              << "                        Lockstep batch engine against GameEngine, per core\n"
+              << "  cache [--games N] [--variants K] [--threads T] [--seed S]\n"
+              << "                        Deal cache on suit-relabeled deals, checked against play\n"
+              << "  tournament [--strategies A,B,...] [--deals N] [--threads T] [--seed S] [--elo E]\n"
+              << "                        Duplicate-deal strategy tournament with early stopping\n"
+              << "  replay [--games N] [--seeks N] [--keyframes K] [--seed S]\n"
+              << "                        Replay seeks from keyframes, checked against straight play\n"
+              << "  tt [--games N] [--threads T] [--mb M] [--seed S]\n"
+              << "                        Transposition table on the positions of played games\n"
+              << "  turns [--games N] [--seed S]\n"
+              << "                        Coroutine turns (playTurn) checked and timed against stepGame\n"
+              << "  tables [--tables N] [--steps N] [--events]\n"
+              << "                        Many concurrent tables stepped round-robin\n"
+              << "  mixer [--periods N]   Mixer cost per period against active voices\n"
+              << "  queue [--count N]     Cost of posting a command to the audio thread\n"
+              << "  alloc-check [--games N] [--seed S]\n"
+              << "                        Fail if games allocate after warm-up (make alloc-check)\n";
+}
+
+// Plays one seeded game on a fresh engine, AI2 choosing with ai2 (null for
+// the default); returns its steps
+template <class Engine>
+long playGame(Engine& engine, unsigned int seed, RankChooser ai2, int wins[3]) {
+    long steps = 0;
+    engine.setStrategy(1, ai2);
+    engine.setSeed(seed);
+    engine.startNewGame();
+    while (engine.stepGame()) {
+        ++steps;
+    }
+    std::string winner = engine.getWinner();
+    ++wins[winner == "AI1" ? 0 : winner == "AI2" ? 1 : 2];
+    return steps;
+}
+
+// Plays one seeded game through playTurn(), resuming each turn to its end;
+// returns the steps stepGame() would have reported
+template <class Engine>
+long playGameByTurns(Engine& engine, unsigned int seed) {
+    long steps = 0;
+    engine.setSeed(seed);
+    engine.startNewGame();
+    while (true) {
+        Generator<EventType> turn = engine.playTurn();
+        while (turn.next()) {
+        }
+        if (engine.getGameState() != GameState::PLAYING) {
+            return steps;
+        }
+        ++steps;
+    }
+}
+
+// Plays seeded games back to back. --sink picks what receives the events:
+// none (GameEngine without a callback), null (QuietGameEngine), callback
+// (a counting callback) or record (RecordingSink). --strategy has AI2 play
+// a built-in strategy against the default AI.
+int benchEngine(int argc, char** argv) {
+    int games = 2000;
+    unsigned int seed = 1;
+    std::string sink = "none";
+    RankChooser ai2 = nullptr;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--sink") == 0 && i + 1 < argc) {
+            sink = argv[++i];
+        } else if (std::strcmp(argv[i], "--strategy") == 0 && i + 1 < argc) {
+            const Strategy* strategy = findStrategy(argv[++i]);
+            if (!strategy) {
+                std::cerr << "Unknown strategy: " << argv[i] << std::endl;
+                return 1;
+            }
+            ai2 = strategy->choose;
+        }
+    }
+    if (sink != "none" && sink != "null" && sink != "callback" && sink != "record") {
+        std::cerr << "Unknown sink: " << sink << std::endl;
+        return 1;
+    }
+
+    long steps = 0;
+    long events = 0;
+    int wins[3] = {0, 0, 0};
+    auto start = std::chrono::steady_clock::now();
+    for (int g = 0; g < games; ++g) {
+        if (sink == "null") {
+            QuietGameEngine engine;
+            steps += playGame(engine, seed + g, ai2, wins);
+        } else if (sink == "record") {
+            BasicGameEngine<RecordingSink> engine;
+            steps += playGame(engine, seed + g, ai2, wins);
+            events += engine.sink().events.size();
+        } else {
+            GameEngine engine;
+            if (sink == "callback") {
+                engine.setEventCallback([&events](const GameEvent&) { ++events; });
+            }
+            steps += playGame(engine, seed + g, ai2, wins);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%d games, %ld steps in %.3f s: %.0f games/s, %.0f steps/s, %.1f ns/step\n",
+                games, steps, seconds, games / seconds, steps / seconds, seconds * 1e9 / steps);
+    std::printf("AI1 %d, AI2 %d, ties %d, %ld events delivered (sink: %s)\n",
+                wins[0], wins[1], wins[2], events, sink.c_str());
+    return 0;
+}
+
+// Plays the same seeds on GameEngine and on both BatchEngine paths, checks
+// every game matches and compares throughput on this one thread. With
+// --cache the batch engine also runs twice against a deal cache.
+int benchBatch(int argc, char** argv) {
+    int games = 20000;
+    unsigned int seed = 1;
+    bool useCache = false;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--cache") == 0) {
+            useCache = true;
+        }
+    }
+
+    std::vector<GameResult> reference(games);
+    GameEngine engine;
+    auto start = std::chrono::steady_clock::now();
+    for (int g = 0; g < games; ++g) {
+        engine.setSeed(seed + g);
+        engine.startNewGame();
+        int steps = 0;
+        while (engine.stepGame()) {
+            ++steps;
+        }
+        reference[g] = GameResult{seed + g, engine.getBooks1(), engine.getBooks2(), steps};
+    }
+    double scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-12s %10.0f games/s\n", "GameEngine", games / scalarSeconds);
+
+    struct Pass {
+        const char* name;
+        bool simd;
+        bool cached;
+    };
+    const Pass passes[] = {{"batch scalar", false, false}, {"batch avx2", true, false},
+                           {"cache cold", true, true}, {"cache warm", true, true}};
+    BatchEngine batch;
+    bool haveSimd = batch.simdEnabled();
+    DealCache cache(2 * games);
+    int failures = 0;
+    for (int pass = 0; pass < (useCache ? 4 : 2); ++pass) {
+        if (passes[pass].simd && !passes[pass].cached && !haveSimd) {
+            std::printf("%-12s not supported by this CPU\n", passes[pass].name);
+            continue;
+        }
+        batch.setSimd(passes[pass].simd);
+        batch.setCache(passes[pass].cached ? &cache : nullptr);
+        uint64_t lookups = cache.lookups();
+        uint64_t hits = cache.hits();
+        std::vector<GameResult> results;
+        start = std::chrono::steady_clock::now();
+        batch.run(seed, games, results);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        int mismatches = 0;
+        for (int g = 0; g < games; ++g) {
+            const GameResult& a = reference[g];
+            const GameResult& b = results[g];
+            if (a.books1 != b.books1 || a.books2 != b.books2 || a.steps != b.steps) {
+                if (mismatches++ < 5) {
+                    std::printf("  seed %u: GameEngine %d-%d in %d steps, batch %d-%d in %d steps\n",
+                                a.seed, a.books1, a.books2, a.steps, b.books1, b.books2, b.steps);
+                }
+            }
+        }
+        failures += mismatches;
+        std::printf("%-12s %10.0f games/s  %.1fx  %d mismatches", passes[pass].name,
+                    games / seconds, scalarSeconds / seconds, mismatches);
+        if (passes[pass].cached) {
+            std::printf("  %.1f%% hits", 100.0 * (cache.hits() - hits) /
+                                         std::max<uint64_t>(1, cache.lookups() - lookups));
+        }
+        std::printf("\n");
+    }
+    return failures > 0 ? 1 : 0;
+}
+
+// A copy of deck with every rank's suits permuted and each hand reordered:
+// a different shuffle that must play out identically
+void relabelDeal(const CardList& deck, CardList& variant, GameRng& rng) {
+    int suits[14][4];
+    for (int r = 1; r <= 13; ++r) {
+        for (int s = 0; s < 4; ++s) {
+            suits[r][s] = s;
+        }
+        std::shuffle(suits[r], suits[r] + 4, rng);
+    }
+    variant = deck;
+    for (auto& card : variant) {
+        card.suit = suits[card.rank][card.suit];
+    }
+    std::shuffle(variant.begin(), variant.begin() + 7, rng);
+    std::shuffle(variant.begin() + 7, variant.begin() + 14, rng);
+}
+
+DealOutcome playDeal(QuietGameEngine& engine, const CardList& deck) {
+    engine.startNewGame(deck);
+    int steps = 0;
+    while (engine.stepGame()) {
+        ++steps;
+    }
+    return DealOutcome{(int16_t)engine.getBooks1(), (int16_t)engine.getBooks2(), steps};
+}
+
+// Plays seeded deals and relabeled variants of them once without and once
+// with the deal cache (shared by --threads workers), and checks every
+// cached outcome against the played one
+int benchCache(int argc, char** argv) {
+    int games = 2000;
+    int variants = 8;
+    int threads = 2;
+    unsigned int seed = 1;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--variants") == 0 && i + 1 < argc) {
+            variants = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+
+    int count = games * variants;
+    std::vector<CardList> deals(count);
+    GameRng rng;
+    for (int g = 0; g < games; ++g) {
+        CardList& base = deals[g * variants];
+        for (int suit = 0; suit < 4; ++suit) {
+            for (int rank = 1; rank <= 13; ++rank) {
+                base.push_back(Card{rank, suit});
+            }
+        }
+        rng.seed(seed + g);
+        std::shuffle(base.begin(), base.end(), rng);
+        for (int v = 1; v < variants; ++v) {
+            relabelDeal(base, deals[g * variants + v], rng);
+        }
+    }
+
+    std::vector<DealOutcome> played(count);
+    QuietGameEngine engine;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        played[i] = playDeal(engine, deals[i]);
+    }
+    double playedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    DealCache cache(2 * count);
+    std::vector<DealOutcome> cached(count);
+    start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            QuietGameEngine local;
+            for (int i = t; i < count; i += threads) {
+                DealKey key = DealKey::fromDeck(&deals[i][0]);
+                if (!cache.find(key, cached[i])) {
+                    cached[i] = playDeal(local, deals[i]);
+                    cache.insert(key, cached[i]);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double cachedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int mismatches = 0;
+    for (int i = 0; i < count; ++i) {
+        const DealOutcome& a = played[i];
+        const DealOutcome& b = cached[i];
+        if (a.books1 != b.books1 || a.books2 != b.books2 || a.steps != b.steps) {
+            if (mismatches++ < 5) {
+                std::printf("  deal %d: played %d-%d in %d steps, cached %d-%d in %d steps\n",
+                            i, a.books1, a.books2, a.steps, b.books1, b.books2, b.steps);
+            }
+        }
+    }
+    std::printf("%d deals (%d seeds x %d variants), %d thread(s)\n", count, games, variants, threads);
+    std::printf("uncached %10.0f deals/s\n", count / playedSeconds);
+    std::printf("cached   %10.0f deals/s  %.1fx  %.1f%% hits, %llu entries, %llu dropped, %.1f MB\n",
+                count / cachedSeconds, playedSeconds / cachedSeconds, 100.0 * cache.hitRate(),
+                (unsigned long long)cache.entries(), (unsigned long long)cache.dropped(),
+                cache.memoryBytes() / 1e6);
+    std::printf("%d mismatches\n", mismatches);
+    return mismatches > 0 ? 1 : 0;
+}
+
+// Plays every pairing of the named strategies (all built-in ones by
+// default) on the same seeded deals with seats swapped, stopping each
+// pairing once it is decided, and prints win rates and Elo ratings
+int benchTournament(int argc, char** argv) {
+    TournamentOptions options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::string names;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--strategies") == 0 && i + 1 < argc) {
+            names = argv[++i];
+        } else if (std::strcmp(argv[i], "--deals") == 0 && i + 1 < argc) {
+            options.maxDeals = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--elo") == 0 && i + 1 < argc) {
+            options.elo1 = std::max(1.0, std::atof(argv[++i]));
+        }
+    }
+
+    std::vector<const Strategy*> strategies;
+    if (names.empty()) {
+        for (int i = 0; i < STRATEGY_COUNT; ++i) {
+            strategies.push_back(&STRATEGIES[i]);
+        }
+    } else {
+        size_t start = 0;
+        while (start <= names.size()) {
+            size_t comma = names.find(',', start);
+            std::string name = names.substr(start, comma == std::string::npos ? std::string::npos
+                                                                             : comma - start);
+            const Strategy* strategy = findStrategy(name);
+            if (!strategy) {
+                std::cerr << "Unknown strategy: " << name << "\n";
+                return 1;
+            }
+            strategies.push_back(strategy);
+            if (comma == std::string::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+    }
+    if (strategies.size() < 2) {
+        std::cerr << "A tournament needs at least two strategies\n";
+        return 1;
+    }
+
+    Tournament tournament(strategies, options);
+    auto start = std::chrono::steady_clock::now();
+    tournament.run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%zu strategies, up to %d deals per pairing, SPRT 0 vs %+.0f Elo, %d thread(s)\n",
+                strategies.size(), options.maxDeals, options.elo1, options.threads);
+    std::printf("%llu games in %.2f s: %.0f games/s\n", (unsigned long long)tournament.gamesPlayed(),
+                seconds, tournament.gamesPlayed() / seconds);
+    std::fflush(stdout);
+    tournament.report(std::cout);
+    return 0;
+}
+
+// Looks up every position of seeded games in a transposition table shared
+// by --threads workers, storing it on a miss with the book difference as
+// its score, then replays the games as a second search would. Checks the
+// engine's incremental hash against one computed from scratch and every
+// hit's score against the position's.
+int benchTranspositions(int argc, char** argv) {
+    int games = 2000;
+    int threads = 2;
+    int megabytes = 16;
+    unsigned int seed = 1;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--mb") == 0 && i + 1 < argc) {
+            megabytes = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+
+    TranspositionTable table(megabytes);
+    std::atomic<uint64_t> hashMismatches(0);
+    std::atomic<uint64_t> scoreMismatches(0);
+    std::printf("%d games, %d thread(s), %zu buckets, %.1f MB\n", games, threads,
+                table.buckets(), table.memoryBytes() / 1e6);
+
+    const char* const passNames[2] = {"first search", "second search"};
+    for (int pass = 0; pass < 2; ++pass) {
+        uint64_t probes = table.probes();
+        uint64_t hits = table.hits();
+        uint64_t replacements = table.replacements();
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                QuietGameEngine engine;
+                for (int g = t; g < games; g += threads) {
+                    engine.setSeed(seed + g);
+                    engine.startNewGame();
+                    do {
+                        PackedPosition position = engine.packPosition();
+                        uint64_t hash = engine.positionHash();
+                        if (hash != Zobrist::hash(position)) {
+                            hashMismatches.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        int score = engine.getBooks1() - engine.getBooks2();
+                        TTData data;
+                        if (table.probe(position, hash, data)) {
+                            if (data.score != score) {
+                                scoreMismatches.fetch_add(1, std::memory_order_relaxed);
+                            }
+                        } else {
+                            table.store(position, hash, score, 0, Bound::EXACT);
+                        }
+                    } while (engine.stepGame());
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        uint64_t passProbes = table.probes() - probes;
+        std::printf("%-14s %9llu positions  %10.0f probes/s  %5.1f%% hits  %llu replacements\n",
+                    passNames[pass], (unsigned long long)passProbes, passProbes / seconds,
+                    100.0 * (table.hits() - hits) / std::max<uint64_t>(1, passProbes),
+                    (unsigned long long)(table.replacements() - replacements));
+        table.newSearch();
+    }
+    std::printf("%.1f%% of entries used, %llu stores\n", 100.0 * table.occupancy(),
+                (unsigned long long)table.stores());
+    std::printf("%llu hash mismatches, %llu score mismatches\n",
+                (unsigned long long)hashMismatches.load(),
+                (unsigned long long)scoreMismatches.load());
+    return hashMismatches.load() + scoreMismatches.load() > 0 ? 1 : 0;
+}
+
+bool sameEvent(const GameEvent& a, const GameEvent& b) {
+    return a.type == b.type && a.player == b.player && a.opponent == b.opponent &&
+           a.rank == b.rank && a.count == b.count && a.drawnCard.rank == b.drawnCard.rank &&
+           a.drawnCard.suit == b.drawnCard.suit;
+}
+
+// Plays the same seeds with stepGame() and playTurn(), checking that every
+// suspension reports the event just emitted and that both engines emit the
+// same events and reach the same positions; then times both without events
+int benchTurns(int argc, char** argv) {
+    int games = 2000;
+    unsigned int seed = 1;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+
+    long mismatches = 0;
+    long suspensions = 0;
+    BasicGameEngine<RecordingSink> stepped;
+    BasicGameEngine<RecordingSink> resumed;
+    for (int g = 0; g < games; ++g) {
+        stepped.setSeed(seed + g);
+        stepped.startNewGame();
+        resumed.setSeed(seed + g);
+        resumed.startNewGame();
+        bool playing = true;
+        while (playing) {
+            playing = stepped.stepGame();
+            Generator<EventType> turn = resumed.playTurn();
+            while (turn.next()) {
+                ++suspensions;
+                if (turn.value() != resumed.sink().events.back().type) {
+                    ++mismatches;
+                }
+            }
+            if (stepped.positionHash() != resumed.positionHash() ||
+                stepped.sink().events.size() != resumed.sink().events.size()) {
+                ++mismatches;
+            }
+        }
+        const std::vector<GameEvent>& a = stepped.sink().events;
+        const std::vector<GameEvent>& b = resumed.sink().events;
+        for (size_t e = 0; e < a.size() && e < b.size(); ++e) {
+            if (!sameEvent(a[e], b[e])) {
+                ++mismatches;
+            }
+        }
+        if (resumed.getGameState() != GameState::GAME_OVER ||
+            stepped.getWinner() != resumed.getWinner()) {
+            ++mismatches;
+        }
+    }
+    std::printf("%d games, %ld suspensions: %ld mismatches\n", games, suspensions, mismatches);
+
+    double seconds[2];
+    long steps[2] = {0, 0};
+    int wins[3] = {0, 0, 0};
+    for (int pass = 0; pass < 2; ++pass) {
+        QuietGameEngine engine;
+        auto start = std::chrono::steady_clock::now();
+        for (int g = 0; g < games; ++g) {
+            steps[pass] += pass == 0 ? playGame(engine, seed + g, nullptr, wins)
+                                     : playGameByTurns(engine, seed + g);
+        }
+        seconds[pass] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    std::printf("stepGame: %ld steps, %.1f ns/step\n", steps[0], seconds[0] * 1e9 / steps[0]);
+    std::printf("playTurn: %ld steps, %.1f ns/step (%.2fx)\n", steps[1],
+                seconds[1] * 1e9 / steps[1], seconds[1] / seconds[0]);
+    return mismatches > 0 || steps[0] != steps[1] ? 1 : 0;
+}
+
+// Records seeded games as replays and seeks to random positions, checking
+// each against the position hash reached by playing straight through, once
+// with a keyframe every K events and once with only the starting keyframe
+int benchReplay(int argc, char** argv) {
+    int games = 200;
+    int seeks = 1000;
+    int keyframeEvents = Replay::DEFAULT_KEYFRAME_EVENTS;
+    unsigned int seed = 1;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seeks") == 0 && i + 1 < argc) {
+            seeks = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--keyframes") == 0 && i + 1 < argc) {
+            keyframeEvents = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+
+    const int NO_KEYFRAMES = 1 << 20;
+    long events = 0;
+    long keyframes = 0;
+    size_t memory = 0;
+    long mismatches = 0;
+    double seconds[2] = {0.0, 0.0};
+    GameRng rng(seed);
+    std::vector<uint64_t> hashes;
+    for (int g = 0; g < games; ++g) {
+        // Hash after every event of a straight play-through, after the
+        // whole turn for its last event
+        QuietGameEngine engine;
+        engine.setSeed(seed + g);
+        engine.startNewGame();
+        hashes.clear();
+        Generator<EventType> turn = engine.playTurn();
+        while (true) {
+            if (turn.next()) {
+                hashes.push_back(engine.positionHash());
+                continue;
+            }
+            hashes.back() = engine.positionHash();
+            if (engine.getGameState() != GameState::PLAYING) {
+                break;
+            }
+            turn = engine.playTurn();
+        }
+
+        Replay replays[2] = {Replay(keyframeEvents), Replay(NO_KEYFRAMES)};
+        for (Replay& replay : replays) {
+            replay.loadSeed(seed + g);
+        }
+        Replay& replay = replays[0];
+        int start = replay.start();
+        if (replay.end() - start != (int)hashes.size()) {
+            ++mismatches;
+            continue;
+        }
+        events += replay.end();
+        keyframes += replay.keyframeCount();
+        memory += replay.memoryBytes();
+
+        std::vector<int> positions(seeks);
+        for (int& position : positions) {
+            position = start + 1 + (int)(rng() % hashes.size());
+        }
+        for (int pass = 0; pass < 2; ++pass) {
+            auto begin = std::chrono::steady_clock::now();
+            for (int position : positions) {
+                GameSnapshot state = replays[pass].seek(position);
+                if (state.hash != hashes[position - start - 1]) {
+                    ++mismatches;
+                }
+            }
+            seconds[pass] += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        }
+    }
+
+    long total = (long)games * seeks;
+    std::printf("%d games, %.1f events and %.1f keyframes per game, %.1f KB per replay\n",
+                games, (double)events / games, (double)keyframes / games, memory / 1024.0 / games);
+    std::printf("keyframe every %d events: %.2f us/seek\n", keyframeEvents,
+                seconds[0] * 1e6 / total);
+    std::printf("from the deal: %.2f us/seek (%.1fx)\n", seconds[1] * 1e6 / total,
+                seconds[1] / seconds[0]);
+    std::printf("%ld seeks: %ld mismatches\n", total * 2, mismatches);
+    return mismatches > 0 ? 1 : 0;
+}
+
+// Steps a contiguous array of engines in turn, as TableGrid does, restarting
+// finished tables in place. With --events each table keeps a suspended
+// playTurn() instead and the round-robin advances every table by one event,
+// so a turn is spread over several passes.
+int benchTables(int argc, char** argv) {
+    int tableCount = 4096;
+    long totalSteps = 2000000;
+    bool byEvent = false;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--tables") == 0 && i + 1 < argc) {
+            tableCount = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--steps") == 0 && i + 1 < argc) {
+            totalSteps = std::max(1L, std::atol(argv[++i]));
+        } else if (std::strcmp(argv[i], "--events") == 0) {
+            byEvent = true;
+        }
+    }
+
+    std::vector<QuietGameEngine> tables(tableCount);
+    for (int t = 0; t < tableCount; ++t) {
+        tables[t].setSeed(t + 1);
+        tables[t].startNewGame();
+    }
+    std::vector<Generator<EventType>> turns(byEvent ? tableCount : 0);
+
+    long steps = 0;
+    long games = 0;
+    long resumes = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (steps < totalSteps) {
+        if (byEvent) {
+            for (int t = 0; t < tableCount; ++t) {
+                ++resumes;
+                if (turns[t].next()) {
+                    continue;
+                }
+                if (tables[t].getGameState() != GameState::PLAYING) {
+                    tables[t].startNewGame();
+                    ++games;
+                }
+                turns[t] = tables[t].playTurn();
+                ++steps;
+            }
+            continue;
+        }
+        for (auto& engine : tables) {
+            if (!engine.stepGame()) {
+                engine.startNewGame();
+                ++games;
+            }
+            ++steps;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%d tables (%zu bytes each, %.1f MB): %ld steps, %ld games in %.3f s\n",
+                tableCount, sizeof(QuietGameEngine), tableCount * sizeof(QuietGameEngine) / 1e6,
+                steps, games, seconds);
+    std::printf("%.0f steps/s, %.1f ns/step\n", steps / seconds, seconds * 1e9 / steps);
+    if (byEvent) {
+        std::printf("%ld resumes, %.1f ns/resume\n", resumes, seconds * 1e9 / resumes);
+    }
+    return 0;
+}
+
+// Cost of one 512-frame stereo period for each kernel and voice count
+int benchMixer(int argc, char** argv) {
+    int periods = 2000;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--periods") == 0 && i + 1 < argc) {
+            periods = std::max(1, std::atoi(argv[++i]));
+        }
+    }
+
+    // One long noise buffer; each voice starts at its own offset so voices
+    // never finish during a run and never share cache lines in lockstep
+    size_t periodSamples = (size_t)BENCH_PERIOD_FRAMES * BENCH_CHANNELS;
+    std::vector<int16_t> noise(periodSamples * (periods + MIXER_VOICE_LIMIT));
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> sample(-8000, 8000);
+    for (auto& s : noise) {
+        s = (int16_t)sample(rng);
+    }
+    std::vector<int16_t> output(periodSamples);
+    std::vector<int16_t> reference(periodSamples);
+
+    const MixKernel kernels[] = {MixKernel::SCALAR, MixKernel::SSE2, MixKernel::AVX2};
+    const int voiceCounts[] = {1, 2, 4, 8, 16, 32, 64};
+
+    std::cout << "periods of " << BENCH_PERIOD_FRAMES << " stereo frames, " << periods
+              << " per run; best kernel here: " << mixKernelName(detectMixKernel()) << "\n";
+    std::cout << "kernel  voices  us/period  ns/voice-frame\n";
+    for (MixKernel kernel : kernels) {
+        if (!isMixKernelSupported(kernel)) {
+            std::cout << mixKernelName(kernel) << "  not supported on this CPU\n";
+            continue;
+        }
+        for (int voices : voiceCounts) {
+            Mixer mixer(BENCH_CHANNELS);
+            mixer.setKernel(kernel);
+            mixer.setMaxVoices(voices);
+            mixer.setMasterVolume(0.5f);
+            for (int v = 0; v < voices; ++v) {
+                mixer.start(noise.data() + v * periodSamples, periodSamples * periods, 0.8f, v);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            for (int p = 0; p < periods; ++p) {
+                mixer.mix(output.data(), BENCH_PERIOD_FRAMES);
+            }
+            double us = std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start).count() / periods;
+
+            // Every kernel must produce the scalar result for the final period
+            Mixer check(BENCH_CHANNELS);
+            check.setKernel(MixKernel::SCALAR);
+            check.setMaxVoices(voices);
+            check.setMasterVolume(0.5f);
+            size_t last = (size_t)(periods - 1) * periodSamples;
+            for (int v = 0; v < voices; ++v) {
+                check.start(noise.data() + v * periodSamples + last, periodSamples, 0.8f, v);
+            }
+            check.mix(reference.data(), BENCH_PERIOD_FRAMES);
+            int maxError = 0;
+            for (size_t i = 0; i < periodSamples; ++i) {
+                maxError = std::max(maxError, std::abs(output[i] - reference[i]));
+            }
+
+            std::printf("%-6s  %6d  %9.2f  %14.3f%s\n", mixKernelName(kernel), voices, us,
+                        us * 1000.0 / (voices * BENCH_PERIOD_FRAMES),
+                        maxError > 1 ? "  MISMATCH" : "");
+        }
+    }
+    return 0;
+}
+
+// Producer-side cost of the game-to-mixer command ring while a consumer
+// thread drains it, as when a game event triggers a sound
+int benchQueue(int argc, char** argv) {
+    long count = 10000000;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc) {
+            count = std::max(1L, std::atol(argv[++i]));
+        }
+    }
+
+    struct Command {
+        int type;
+        int sound;
+        const int16_t* samples;
+        size_t count;
+        float gain;
+    };
+    static SpscRing<Command, AUDIO_COMMAND_CAPACITY> ring;
+
+    std::atomic<bool> done(false);
+    long received = 0;
+    std::thread consumer([&]() {
+        Command command;
+        while (!done.load(std::memory_order_acquire) || ring.size() > 0) {
+            while (ring.pop(command)) {
+                ++received;
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    // Push in bursts that fit the ring and time only the pushes, so the
+    // result does not depend on how often the consumer gets a core
+    const long burst = AUDIO_COMMAND_CAPACITY / 2;
+    long full = 0;
+    double ns = 0.0;
+    Command command = {0, 1, nullptr, 0, 1.0f};
+    for (long sent = 0; sent < count; sent += burst) {
+        while (ring.size() > 0) {
+            std::this_thread::yield();
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (long i = 0; i < burst; ++i) {
+            command.sound = (int)i;
+            if (!ring.push(command)) {
+                ++full;
+            }
+        }
+        ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+    long pushed = (count + burst - 1) / burst * burst;
+    done = true;
+    consumer.join();
+
+    std::printf("%ld pushes: %.2f ns/push, %ld delivered, %ld rejected\n",
+                pushed, ns / pushed, received, full);
+    return 0;
+}
+
+// Plays games on one warmed-up engine with an event consumer attached, first
+// with stepGame() and then with playTurn(), and fails if any of them touches
+// the heap. Needs the allocation-tracking build.
+int benchAllocCheck(int argc, char** argv) {
+    int games = 200;
+    unsigned int seed = 1;
+    for (int i = 0; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            games = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+    if (!AllocTracker::enabled()) {
+        std::cerr << "alloc-check needs a build with -DGOFISH_ALLOC_TRACK (make alloc-check)"
+                  << std::endl;
+        return 1;
+    }
+
+    long events = 0;
+    GameEngine engine;
+    engine.setEventCallback([&events](const GameEvent&) { ++events; });
+    engine.setSeed(seed);
+    engine.startNewGame();
+    while (engine.stepGame()) {
+    }
+    playGameByTurns(engine, seed);
+
+    AllocTracker::reset();
+    long steps = 0;
+    for (int g = 0; g < games; ++g) {
+        engine.setSeed(seed + g);
+        engine.startNewGame();
+        while (engine.stepGame()) {
+            ++steps;
+        }
+    }
+    for (int g = 0; g < games; ++g) {
+        steps += playGameByTurns(engine, seed + g);
+    }
+    AllocTracker::Totals totals = AllocTracker::totals();
+
+    std::printf("%d games twice (stepGame, playTurn), %ld steps, %ld events after warm-up: "
+                "%llu allocations\n", games, steps, events, (unsigned long long)totals.allocations);
+    if (totals.allocations > 0) {
+        AllocTracker::report(std::cout);
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1];
+    std::string tracePath;
+    for (int i = 2; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], "--trace") == 0) {
+            tracePath = argv[i + 1];
+            Tracer::start();
+            Tracer::setThreadName("main");
+        }
+    }
+
+    int result;
+    if (command == "engine") {
+        result = benchEngine(argc - 2, argv + 2);
+    } else if (command == "batch") {
+        result = benchBatch(argc - 2, argv + 2);
+    } else if (command == "cache") {
+        result = benchCache(argc - 2, argv + 2);
+    } else if (command == "tournament") {
+        result = benchTournament(argc - 2, argv + 2);
+    } else if (command == "replay") {
+        result = benchReplay(argc - 2, argv + 2);
+    } else if (command == "tt") {
+        result = benchTranspositions(argc - 2, argv + 2);
+    } else if (command == "turns") {
+        result = benchTurns(argc - 2, argv + 2);
+    } else if (command == "tables") {
+        result = benchTables(argc - 2, argv + 2);
+    } else if (command == "mixer") {
+        result = benchMixer(argc - 2, argv + 2);
+    } else if (command == "queue") {
+        result = benchQueue(argc - 2, argv + 2);
+    } else if (command == "alloc-check") {
+        result = benchAllocCheck(argc - 2, argv + 2);
+    } else {
+        printUsage(argv[0]);
+        return 1;
+    }
+    Profiler::report(std::cout);
+    if (!tracePath.empty()) {
+        Tracer::write(tracePath);
+    }
+    return result;
+}
@@ -0,0 +1,381 @@
+// gofish-loadgen: drives a running gofish-server with bot moves and reports
+// moves/s and move latency for several table counts
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <vector>
+#include "LatencyHistogram.h"
+#include "Protocol.h"
+
+namespace {
+
+const size_t READ_CHUNK = 64 * 1024;
+
+struct Options {
+    std::string socketPath = Protocol::DEFAULT_SOCKET;
+    std::vector<int> tableCounts = {1000, 10000, 100000};
+    int connections = 4;
+    int window = 64;      // Requests in flight per connection
+    double seconds = 2.0; // Of moves per table count
+    int subscribe = 0;    // Tables watched for events, from the first connection
+};
+
+enum class Phase {
+    CREATE,
+    SUBSCRIBE,
+    MOVES,
+    CLOSE
+};
+
+// Per-table request in flight; a table never has two
+enum Pending : uint8_t {
+    IDLE,
+    MOVE,
+    NEW_GAME,
+    OTHER
+};
+
+struct Connection {
+    int fd = -1;
+    std::vector<uint8_t> in;
+    std::vector<uint8_t> out;
+    size_t written = 0;
+    std::vector<uint32_t> tables;   // Server ids; requests are tagged with the index
+    std::vector<uint8_t> pending;   // Pending per table
+    std::vector<uint64_t> sentAt;   // monotonicNs() of the pending MOVE
+    size_t next = 0;                // Next table to issue to
+    size_t end = 0;                 // Tables this phase covers, except MOVES
+    unsigned int seedBase = 0;      // Seed of table 0's first deal
+    int outstanding = 0;
+};
+
+struct Run {
+    std::vector<Connection> connections;
+    Phase phase = Phase::CREATE;
+    bool issuing = true;
+    int window = 64;
+    unsigned int seed = 1;
+    LatencyHistogram latency;
+    uint64_t moves = 0;
+    uint64_t games = 0;
+    uint64_t events = 0;
+    uint64_t errors = 0;
+};
+
+void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]   (start gofish-server first)\n"
+              << "  --socket PATH         Server socket (default " << Protocol::DEFAULT_SOCKET << ")\n"
+              << "  --tables N[,N...]     Table counts to run (default 1000,10000,100000)\n"
+              << "  --connections N       Client connections (default 4)\n"
+              << "  --window N            Requests in flight per connection (default 64)\n"
+              << "  --seconds X           Duration of each run (default 2)\n"
+              << "  --subscribe N         Watch the events of N tables (default 0)\n";
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (arg == "--tables" && hasValue) {
+            options.tableCounts.clear();
+            for (const char* p = argv[++i]; *p;) {
+                options.tableCounts.push_back(std::max(1, std::atoi(p)));
+                const char* comma = std::strchr(p, ',');
+                p = comma ? comma + 1 : p + std::strlen(p);
+            }
+        } else if (arg == "--connections" && hasValue) {
+            options.connections = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--window" && hasValue) {
+            options.window = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = std::max(0.1, std::atof(argv[++i]));
+        } else if (arg == "--subscribe" && hasValue) {
+            options.subscribe = std::max(0, std::atoi(argv[++i]));
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return !options.tableCounts.empty();
+}
+
+int connectTo(const std::string& path) {
+    sockaddr_un address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (const sockaddr*)&address, sizeof(address)) < 0) {
+        std::cerr << "Cannot connect to " << path << ": " << std::strerror(errno) << std::endl;
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+void sendRequest(Connection& connection, uint8_t type, uint32_t index, unsigned int seed) {
+    Protocol::Request request = Protocol::Request();
+    request.type = type;
+    request.tag = index;
+    request.table = connection.tables[index];
+    request.seed = seed;
+    uint8_t bytes[Protocol::MAX_FRAME];
+    int size = Protocol::encodeRequest(request, bytes);
+    connection.out.insert(connection.out.end(), bytes, bytes + size);
+    ++connection.outstanding;
+}
+
+// Tops the connection up to the window with requests for the current phase
+void issue(Run& run, Connection& connection) {
+    size_t count = connection.tables.size();
+    while (run.issuing && connection.outstanding < run.window) {
+        if (run.phase == Phase::MOVES) {
+            // Next idle table, round-robin
+            size_t tried = 0;
+            while (tried < count && connection.pending[connection.next] != IDLE) {
+                connection.next = (connection.next + 1) % count;
+                ++tried;
+            }
+            if (tried == count) {
+                return;
+            }
+            uint32_t index = (uint32_t)connection.next;
+            connection.next = (connection.next + 1) % count;
+            connection.pending[index] = MOVE;
+            connection.sentAt[index] = monotonicNs();
+            sendRequest(connection, Protocol::MOVE, index, 0);
+            continue;
+        }
+
+        if (connection.next >= connection.end) {
+            return;
+        }
+        uint32_t index = (uint32_t)connection.next++;
+        connection.pending[index] = OTHER;
+        if (run.phase == Phase::CREATE) {
+            sendRequest(connection, Protocol::CREATE_TABLE, index, connection.seedBase + index);
+        } else if (run.phase == Phase::SUBSCRIBE) {
+            sendRequest(connection, Protocol::SUBSCRIBE, index, 0);
+        } else {
+            sendRequest(connection, Protocol::CLOSE_TABLE, index, 0);
+        }
+    }
+}
+
+void handleReply(Run& run, Connection& connection, const Protocol::Reply& reply) {
+    uint32_t index = reply.tag;
+    if (index >= connection.tables.size() || connection.pending[index] == IDLE) {
+        ++run.errors;
+        return;
+    }
+    uint8_t pending = connection.pending[index];
+    connection.pending[index] = IDLE;
+    --connection.outstanding;
+    if (run.phase == Phase::CREATE) {
+        connection.tables[index] = reply.table;
+    }
+    if (reply.status != Protocol::OK && reply.status != Protocol::GAME_OVER) {
+        ++run.errors;
+        return;
+    }
+    if (pending == MOVE) {
+        run.latency.record(monotonicNs() - connection.sentAt[index]);
+        if (reply.status == Protocol::OK) {
+            ++run.moves;
+        } else if (run.issuing) {
+            // The bot starts the next game at the same table
+            connection.pending[index] = NEW_GAME;
+            sendRequest(connection, Protocol::NEW_GAME, index, run.seed + (unsigned int)run.games);
+        }
+    } else if (pending == NEW_GAME) {
+        ++run.games;
+    }
+}
+
+// One round of socket I/O over all connections; false if the server went away
+bool pump(Run& run, int timeoutMs) {
+    std::vector<pollfd> fds(run.connections.size());
+    for (size_t i = 0; i < fds.size(); ++i) {
+        const Connection& connection = run.connections[i];
+        fds[i].fd = connection.fd;
+        fds[i].events = POLLIN | (connection.written < connection.out.size() ? POLLOUT : 0);
+        fds[i].revents = 0;
+    }
+    if (poll(fds.data(), fds.size(), timeoutMs) < 0) {
+        return errno == EINTR;
+    }
+
+    static uint8_t buffer[READ_CHUNK];
+    for (size_t i = 0; i < fds.size(); ++i) {
+        Connection& connection = run.connections[i];
+        if (fds[i].revents & POLLOUT) {
+            ssize_t sent = send(connection.fd, connection.out.data() + connection.written,
+                                connection.out.size() - connection.written,
+                                MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (sent < 0 && errno != EAGAIN && errno != EINTR) {
+                return false;
+            }
+            connection.written += std::max<ssize_t>(0, sent);
+            if (connection.written == connection.out.size()) {
+                connection.out.clear();
+                connection.written = 0;
+            }
+        }
+        if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t got = recv(connection.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+            if (got == 0 || (got < 0 && errno != EAGAIN && errno != EINTR)) {
+                std::cerr << "Server closed the connection" << std::endl;
+                return false;
+            }
+            if (got > 0) {
+                connection.in.insert(connection.in.end(), buffer, buffer + got);
+            }
+            size_t offset = 0;
+            for (;;) {
+                const uint8_t* frame = connection.in.data() + offset;
+                int size = Protocol::frameSize(frame, connection.in.size() - offset);
+                if (size == 0) {
+                    break;
+                }
+                Protocol::Reply reply;
+                Protocol::EventFrame event;
+                if (size > 0 && Protocol::decodeReply(frame, size, reply)) {
+                    handleReply(run, connection, reply);
+                } else if (size > 0 && Protocol::decodeEvent(frame, size, event)) {
+                    ++run.events;
+                } else {
+                    std::cerr << "Malformed frame from server" << std::endl;
+                    return false;
+                }
+                offset += size;
+            }
+            connection.in.erase(connection.in.begin(), connection.in.begin() + offset);
+        }
+    }
+    for (Connection& connection : run.connections) {
+        issue(run, connection);
+    }
+    return true;
+}
+
+// Issues one request for each of the first `end` tables of every
+// connection and waits for all the replies. watched limits SUBSCRIBE to
+// the first connection's first tables.
+bool runPhase(Run& run, Phase phase, size_t watched) {
+    run.phase = phase;
+    run.issuing = true;
+    for (size_t c = 0; c < run.connections.size(); ++c) {
+        Connection& connection = run.connections[c];
+        connection.next = 0;
+        connection.end = connection.tables.size();
+        if (phase == Phase::SUBSCRIBE) {
+            connection.end = c == 0 ? std::min(watched, connection.end) : 0;
+        }
+        issue(run, connection);
+    }
+    for (;;) {
+        bool done = true;
+        for (const Connection& connection : run.connections) {
+            done = done && connection.outstanding == 0 && connection.next >= connection.end;
+        }
+        if (done) {
+            return true;
+        }
+        if (!pump(run, 100)) {
+            return false;
+        }
+    }
+}
+
+bool runTables(const Options& options, int tables) {
+    Run run;
+    run.window = options.window;
+    for (int c = 0; c < options.connections; ++c) {
+        Connection connection;
+        connection.fd = connectTo(options.socketPath);
+        if (connection.fd < 0) {
+            return false;
+        }
+        size_t share = tables / options.connections + (c < tables % options.connections ? 1 : 0);
+        connection.tables.assign(share, 0);
+        connection.pending.assign(share, IDLE);
+        connection.sentAt.assign(share, 0);
+        connection.seedBase = run.seed + (unsigned int)(c * (tables / options.connections + 1));
+        run.connections.push_back(connection);
+    }
+
+    bool ok = runPhase(run, Phase::CREATE, 0);
+    if (ok && options.subscribe > 0) {
+        ok = runPhase(run, Phase::SUBSCRIBE, (size_t)options.subscribe);
+    }
+
+    if (ok) {
+        run.phase = Phase::MOVES;
+        run.issuing = true;
+        for (Connection& connection : run.connections) {
+            connection.next = 0;
+            issue(run, connection);
+        }
+        auto start = std::chrono::steady_clock::now();
+        double elapsed = 0;
+        while (ok && elapsed < options.seconds) {
+            ok = pump(run, 10);
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        run.issuing = false;
+        uint64_t moves = run.moves;
+        while (ok) {
+            bool drained = true;
+            for (const Connection& connection : run.connections) {
+                drained = drained && connection.outstanding == 0;
+            }
+            if (drained) {
+                break;
+            }
+            ok = pump(run, 100);
+        }
+
+        char summary[128];
+        run.latency.format(summary, sizeof(summary));
+        std::printf("%7d tables  %9.0f moves/s  %s  %llu games, %llu events, %llu errors\n",
+                    tables, moves / elapsed, summary, (unsigned long long)run.games,
+                    (unsigned long long)run.events, (unsigned long long)run.errors);
+    }
+
+    if (ok) {
+        ok = runPhase(run, Phase::CLOSE, 0);
+    }
+    for (Connection& connection : run.connections) {
+        close(connection.fd);
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    std::printf("%d connection(s), %d request(s) in flight each, %.1f s per run\n",
+                options.connections, options.window, options.seconds);
+    for (int tables : options.tableCounts) {
+        if (!runTables(options, tables)) {
+            return 1;
+        }
+    }
+    return 0;
+}
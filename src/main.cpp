@@ -1,63 +1,417 @@
 #include <iostream>
+#include <atomic>
 #include <chrono>
 #include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 #include "GameEngine.h"
 #include "UIManager.h"
 #include "AudioManager.h"
+#include "LatencyHistogram.h"
+#include "Replay.h"
+#include "Profiler.h"
+#include "Tracer.h"
+
+struct Options {
+    bool headless = false;
+    int frames = 0;          // 0 = until the game is over
+    std::string dumpDir;     // Where headless frames are written
+    std::string dumpFormat = "ppm";
+    int dumpEvery = 1;
+    std::string frameTimesPath;
+    float speed = 1.0f;
+    bool hasSeed = false;
+    unsigned int seed = 0;
+    int gridColumns = 0;     // > 0 selects the multi-table spectator grid
+    int gridRows = 0;
+    std::string replaySource; // Seed (all digits) or replay file to view
+    int replayTurn = 0;
+    std::string saveReplayPath;
+    bool hasAudio = false;   // Headless runs are silent unless --audio is given
+    std::string audioSink;
+    int maxVoices = 0;       // 0 = mixer default
+    bool latencyOverlay = false;
+    bool hud = false;
+    std::string tracePath;   // Chrome trace JSON written on exit
+};
+
+static void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "  --headless            Render offscreen without an X server\n"
+              << "  --frames N            Headless: stop after N frames (default: game over)\n"
+              << "  --dump-dir DIR        Headless: write frames to DIR\n"
+              << "  --dump-format FMT     Headless: ppm (default) or png\n"
+              << "  --dump-every N        Headless: write every Nth frame\n"
+              << "  --frame-times FILE    Headless: write per-frame render times (ms)\n"
+              << "  --speed X             Initial playback speed multiplier\n"
+              << "  --seed N              Deal reproducible games\n"
+              << "  --grid N | CxR        Watch N x N (or C x R) tables at once\n"
+              << "  --replay SEED|FILE    Scrub through the game dealt by SEED, or a saved replay\n"
+              << "  --replay-turn N       Open the replay at turn N (default 1)\n"
+              << "  --save-replay FILE    Write the replayed game's deal and event log to FILE\n"
+              << "  --audio SINK          Audio output: alsa[:device], null or wav:FILE\n"
+              << "  --max-voices N        Most sounds playing at once (1-64, default 16)\n"
+              << "  --latency             Start with the event latency overlay shown (L)\n"
+              << "  --hud                 Start with the performance HUD shown (H)\n"
+              << "  --trace FILE          Record a Chrome trace (Perfetto) timeline to FILE\n";
+}
+
+static bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--dump-dir" && hasValue) {
+            options.dumpDir = argv[++i];
+        } else if (arg == "--dump-format" && hasValue) {
+            options.dumpFormat = argv[++i];
+        } else if (arg == "--dump-every" && hasValue) {
+            options.dumpEvery = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--frame-times" && hasValue) {
+            options.frameTimesPath = argv[++i];
+        } else if (arg == "--speed" && hasValue) {
+            options.speed = std::atof(argv[++i]);
+        } else if (arg == "--grid" && hasValue) {
+            std::string grid = argv[++i];
+            size_t x = grid.find('x');
+            options.gridColumns = std::atoi(grid.c_str());
+            options.gridRows = x == std::string::npos ? options.gridColumns
+                                                      : std::atoi(grid.c_str() + x + 1);
+            if (options.gridColumns <= 0 || options.gridRows <= 0) {
+                printUsage(argv[0]);
+                return false;
+            }
+        } else if (arg == "--replay" && hasValue) {
+            options.replaySource = argv[++i];
+        } else if (arg == "--replay-turn" && hasValue) {
+            options.replayTurn = std::max(1, std::atoi(argv[++i])) - 1;
+        } else if (arg == "--save-replay" && hasValue) {
+            options.saveReplayPath = argv[++i];
+        } else if (arg == "--audio" && hasValue) {
+            options.audioSink = argv[++i];
+            options.hasAudio = true;
+        } else if (arg == "--trace" && hasValue) {
+            options.tracePath = argv[++i];
+        } else if (arg == "--latency") {
+            options.latencyOverlay = true;
+        } else if (arg == "--hud") {
+            options.hud = true;
+        } else if (arg == "--max-voices" && hasValue) {
+            options.maxVoices = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoul(argv[++i], nullptr, 10);
+            options.hasSeed = true;
+        } else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    if (!options.saveReplayPath.empty() && options.replaySource.empty()) {
+        std::cerr << "--save-replay needs --replay" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Loads --replay and writes --save-replay; null after printing why not
+static std::unique_ptr<Replay> loadReplay(const Options& options) {
+    std::unique_ptr<Replay> replay(new Replay());
+    const std::string& source = options.replaySource;
+    bool loaded = source.find_first_not_of("0123456789") == std::string::npos
+                      ? replay->loadSeed(std::strtoul(source.c_str(), nullptr, 10))
+                      : replay->loadFile(source);
+    if (!loaded) {
+        return nullptr;
+    }
+    if (!options.saveReplayPath.empty() && !replay->save(options.saveReplayPath)) {
+        return nullptr;
+    }
+    return replay;
+}
+
+// Forward engine events to the UI and trigger the matching sounds
+static void connectEvents(GameEngine& gameEngine, UIManager& uiManager, AudioManager* audioManager) {
+    // Resolve sound names once; the callback only passes IDs to the mixer
+    SoundId victorySound = audioManager ? audioManager->findSound("victory") : INVALID_SOUND;
+    SoundId cardMoveSound = audioManager ? audioManager->findSound("card_move") : INVALID_SOUND;
+    uiManager.setAudioManager(audioManager);
+
+    gameEngine.setEventCallback([&uiManager, audioManager, victorySound, cardMoveSound](const GameEvent& event) {
+        // Handle game events
+        uiManager.onGameEvent(event);
+
+        if (!audioManager) {
+            return;
+        }
+        if (event.type == EventType::GAME_ENDED) {
+            // Play victory sound
+            audioManager->playSound(victorySound, event.timestamp);
+        } else if (event.type == EventType::CARDS_TRANSFERRED) {
+            // Play card move sound
+            audioManager->playSound(cardMoveSound, event.timestamp);
+        }
+    });
+}
+
+// Opens the audio device and decodes the sound bank on a thread of its own
+// while the window comes up. Nothing on the welcome screen makes a sound, so
+// the main loop only waits for it once a game or view starts.
+class AudioStartup {
+public:
+    AudioStartup(AudioManager& audio, const std::string& sinkSpec) : m_readyNs(0) {
+        m_thread = std::thread([this, &audio, sinkSpec] {
+            Tracer::setThreadName("audio startup");
+            {
+                TRACE_SPAN("audio", "startup");
+                audio.initialize(sinkSpec);
+            }
+            m_readyNs = monotonicNs();
+        });
+    }
+    ~AudioStartup() { finish(); }
+
+    bool pending() const { return m_thread.joinable(); }
+    void finish() {
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+    uint64_t readyNs() const { return m_readyNs; } // 0 until initialized
+
+private:
+    std::thread m_thread;
+    std::atomic<uint64_t> m_readyNs;
+};
+
+// Cold-start phases, in ms since main() began
+static void printStartup(uint64_t startNs, uint64_t windowNs, const FrameStats& stats,
+                         uint64_t audioReadyNs) {
+    printf("Startup: window %.1f ms, first Expose %.1f ms, first frame %.1f ms, "
+           "audio ready %.1f ms (in parallel)\n",
+           (windowNs - startNs) / 1e6, (stats.firstExposeNs - startNs) / 1e6,
+           (stats.firstPresentNs - startNs) / 1e6, (audioReadyNs - startNs) / 1e6);
+}
+
+// Summarise event latencies on exit
+static void printLatency(const UIManager& uiManager, const AudioManager* audioManager) {
+    char summary[128];
+    if (audioManager && audioManager->getSoundLatency().count() > 0) {
+        audioManager->getSoundLatency().format(summary, sizeof(summary));
+        printf("Event-to-sound latency: %s\n", summary);
+    }
+    if (uiManager.getPixelLatency().count() > 0) {
+        uiManager.getPixelLatency().format(summary, sizeof(summary));
+        printf("Event-to-pixel latency: %s\n", summary);
+    }
+}
+
+// Plays one game (or, in grid mode, a fixed number of frames) offscreen at a
+// fixed 60 Hz timestep and reports how long each rendered frame took
+static int runHeadless(const Options& options) {
+    GameEngine gameEngine;
+    if (options.hasSeed) {
+        gameEngine.setSeed(options.seed);
+    }
+
+    UIManager uiManager;
+    uiManager.initializeHeadless(1024, 768);
+    uiManager.setGameEngine(&gameEngine);
+    uiManager.setPlaybackSpeed(options.speed);
+
+    AudioManager audioManager;
+    if (options.maxVoices > 0) {
+        audioManager.setMaxVoices(options.maxVoices);
+    }
+    if (options.hasAudio) {
+        audioManager.initialize(options.audioSink);
+    }
+    connectEvents(gameEngine, uiManager, options.hasAudio ? &audioManager : nullptr);
+    if (options.latencyOverlay) {
+        uiManager.toggleLatencyOverlay();
+    }
+    if (options.hud) {
+        uiManager.togglePerformanceHud();
+    }
+
+    bool grid = options.gridColumns > 0;
+    bool replay = !options.replaySource.empty();
+    if (grid) {
+        uiManager.enterGridMode(options.gridColumns, options.gridRows, options.seed);
+    } else if (replay) {
+        std::unique_ptr<Replay> loaded = loadReplay(options);
+        if (!loaded) {
+            return 1;
+        }
+        uiManager.enterReplayMode(std::move(loaded), options.replayTurn);
+    } else {
+        uiManager.startGame();
+    }
+    int frames = options.frames == 0 && grid ? 600 : options.frames;
+
+    const float deltaTime = 1.0f / 60.0f;
+    std::vector<double> frameTimes;
+    for (int frame = 0; frames == 0 || frame < frames; ++frame) {
+        uiManager.update(deltaTime);
+        if (!grid) {
+            uiManager.requestRedraw();
+        }
+        long rendered = uiManager.getFrameStats().frames;
+        uiManager.render();
+        if (uiManager.getFrameStats().frames != rendered) {
+            frameTimes.push_back(uiManager.getFrameStats().lastMs);
+        }
+
+        if (!options.dumpDir.empty() && frame % options.dumpEvery == 0) {
+            char name[64];
+            snprintf(name, sizeof(name), "/frame_%06d.%s", frame, options.dumpFormat.c_str());
+            if (!uiManager.saveFrame(options.dumpDir + name)) {
+                std::cerr << "Failed to write " << options.dumpDir << name << std::endl;
+                return 1;
+            }
+        }
+        if (frames == 0 && (uiManager.getState() == UIState::END_GAME ||
+                            (replay && uiManager.replayAtEnd()))) {
+            break;
+        }
+    }
+
+    if (!options.frameTimesPath.empty()) {
+        FILE* f = fopen(options.frameTimesPath.c_str(), "w");
+        if (f) {
+            for (double ms : frameTimes) {
+                fprintf(f, "%.4f\n", ms);
+            }
+            fclose(f);
+        }
+    }
+
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    double total = 0.0;
+    for (double ms : sorted) total += ms;
+    printf("Rendered %zu frames: mean %.3f ms, p50 %.3f ms, p99 %.3f ms, max %.3f ms\n",
+           n, n ? total / n : 0.0, n ? sorted[n / 2] : 0.0,
+           n ? sorted[std::min(n - 1, n * 99 / 100)] : 0.0, n ? sorted[n - 1] : 0.0);
+    printLatency(uiManager, options.hasAudio ? &audioManager : nullptr);
+    audioManager.cleanup(); // Join the mixer so its totals are final
+    Profiler::report(std::cout);
+    if (!options.tracePath.empty()) {
+        Tracer::write(options.tracePath);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint64_t startNs = monotonicNs();
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    if (!options.tracePath.empty()) {
+        Tracer::start();
+        Tracer::setThreadName("main");
+    }
+    if (options.headless) {
+        return runHeadless(options);
+    }
 
-int main() {
     std::cout << "Starting Go Fish Game..." << std::endl;
-    
+
     // Create game engine
     GameEngine gameEngine;
-    
+    if (options.hasSeed) {
+        gameEngine.setSeed(options.seed);
+    }
+
+    // Create audio manager; it starts up while the window opens
+    AudioManager audioManager;
+    if (options.maxVoices > 0) {
+        audioManager.setMaxVoices(options.maxVoices);
+    }
+    AudioStartup audioStartup(audioManager, options.audioSink);
+
     // Create UI manager
     UIManager uiManager;
-    if (!uiManager.initialize(1024, 768)) {
-        std::cerr << "Failed to initialize UI" << std::endl;
-        return 1;
+    {
+        TRACE_SPAN("window", "startup");
+        if (!uiManager.initialize(1024, 768)) {
+            std::cerr << "Failed to initialize UI" << std::endl;
+            return 1;
+        }
     }
-    
-    // Create audio manager
-    AudioManager audioManager;
-    audioManager.initialize();
-    
+    uint64_t windowNs = monotonicNs();
+    uiManager.setPlaybackSpeed(options.speed);
+
     // Connect game engine to UI
     uiManager.setGameEngine(&gameEngine);
-    
-    // Set up game event callback
-    gameEngine.setEventCallback([&uiManager, &audioManager](const GameEvent& event) {
-        // Handle game events
-        if (event.type == EventType::GAME_ENDED) {
-            // Play victory sound
-            audioManager.playSound("victory");
-        } else if (event.type == EventType::CARDS_TRANSFERRED) {
-            // Play card move sound
-            audioManager.playSound("card_move");
+    if (options.gridColumns > 0) {
+        uiManager.enterGridMode(options.gridColumns, options.gridRows, options.seed);
+    } else if (!options.replaySource.empty()) {
+        std::unique_ptr<Replay> replay = loadReplay(options);
+        if (!replay) {
+            return 1;
         }
-    });
-    
+        uiManager.enterReplayMode(std::move(replay), options.replayTurn);
+    }
+
+    // Set up game event callback, without sounds until audio is up
+    connectEvents(gameEngine, uiManager, nullptr);
+    if (options.latencyOverlay) {
+        uiManager.toggleLatencyOverlay();
+    }
+    if (options.hud) {
+        uiManager.togglePerformanceHud();
+    }
+
     // Main game loop
     auto lastTime = std::chrono::high_resolution_clock::now();
-    
+    bool startupReported = false;
+
     while (uiManager.isRunning()) {
         auto currentTime = std::chrono::high_resolution_clock::now();
         float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
         lastTime = currentTime;
-        
+
         // Handle events
         uiManager.handleEvents();
-        
+
+        // The game's first sound may be a step away
+        if (audioStartup.pending() && uiManager.getState() != UIState::WELCOME) {
+            audioStartup.finish();
+            connectEvents(gameEngine, uiManager, &audioManager);
+        }
+
         // Update game state
         uiManager.update(deltaTime);
-        
+
         // Render
         uiManager.render();
-        
+
+        if (!startupReported && uiManager.getFrameStats().firstPresentNs &&
+            audioStartup.readyNs()) {
+            printStartup(startNs, windowNs, uiManager.getFrameStats(), audioStartup.readyNs());
+            startupReported = true;
+        }
+
         // Cap frame rate to ~60 FPS
         std::this_thread::sleep_for(std::chrono::milliseconds(16));
     }
-    
+
+    audioStartup.finish();
+    printLatency(uiManager, &audioManager);
+    audioManager.cleanup();
+    Profiler::report(std::cout);
+    if (!options.tracePath.empty()) {
+        Tracer::write(options.tracePath);
+    }
     std::cout << "Game closed. Goodbye!" << std::endl;
     return 0;
-}
\ No newline at end of file
+}
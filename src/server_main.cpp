@@ -0,0 +1,63 @@
+// gofish-server: hosts Go Fish tables for local bots and viewers over a
+// Unix-domain socket; see Protocol.h for the wire format
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include "GameServer.h"
+
+namespace {
+
+GameServer* g_server = nullptr;
+
+void handleSignal(int) {
+    if (g_server) {
+        g_server->stop();
+    }
+}
+
+void printUsage(const char* argv0) {
+    std::cout << "Usage: " << argv0 << " [options]\n"
+              << "  --socket PATH         Listen on PATH (default " << Protocol::DEFAULT_SOCKET << ")\n"
+              << "  --shards N            Table worker threads (default: one per core)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string socketPath = Protocol::DEFAULT_SOCKET;
+    int shards = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--socket" && hasValue) {
+            socketPath = argv[++i];
+        } else if (arg == "--shards" && hasValue) {
+            shards = std::max(1, std::atoi(argv[++i]));
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    GameServer server;
+    if (!server.start(socketPath, shards)) {
+        return 1;
+    }
+    g_server = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::cout << "Listening on " << socketPath << " with " << shards << " shard(s)" << std::endl;
+
+    server.run();
+
+    std::printf("Served %llu connection(s); %llu tables open, %llu moves, %llu events\n",
+                (unsigned long long)server.connectionsServed(),
+                (unsigned long long)server.tables(), (unsigned long long)server.moves(),
+                (unsigned long long)server.events());
+    g_server = nullptr;
+    return 0;
+}